@@ -40,7 +40,8 @@ class SQLite3 {
 public:
     SQLite3(const SQLite3 &) = delete;
     SQLite3 & operator=(const SQLite3 &) = delete;
-    SQLite3(const char *dbPath);
+    enum class Mode { EXCLUSIVE, SHARED, READ_ONLY };
+    SQLite3(const char *dbPath, Mode mode = Mode::EXCLUSIVE);
     void close();
 };
 
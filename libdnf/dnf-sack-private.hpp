@@ -22,9 +22,11 @@
 #define HY_SACK_INTERNAL_H
 
 #include <stdio.h>
+#include <string>
 #include <solv/pool.h>
 
 #include "dnf-sack.h"
+#include "sack/advisoryindex.hpp"
 #include "sack/packageset.hpp"
 
 typedef Id  (*dnf_sack_running_kernel_fn_t) (DnfSack    *sack);
@@ -55,6 +57,91 @@ int dnf_sack_get_pool_nsolvables(DnfSack *sack);
  */
 libdnf::PackageSet *dnf_sack_get_pkg_solvables(DnfSack *sack);
 
+/**
+ * @brief Returns ids of all package solvables with the given name. The index is built lazily on
+ *        first use and dropped whenever repos are added or removed.
+ *
+ * @param sack p_sack:...
+ * @param name Id of the package name
+ * @param count p_count: Number of returned ids
+ * @return const Id* Ids sorted in ascending order, valid until the next change of the pool
+ */
+const Id *dnf_sack_get_name_index(DnfSack *sack, Id name, int *count);
+
+/**
+ * @brief Returns all package solvables ordered by name Id, evr (newest first) and solvable Id,
+ *        with by_arch by name Id, arch Id, evr and solvable Id. Built lazily on first use and
+ *        dropped whenever repos are added or removed.
+ *
+ * @param sack p_sack:...
+ * @param by_arch p_by_arch: Order packages of the same name by arch first
+ * @param count p_count: Number of returned ids
+ * @return const Id* valid until the next change of the pool
+ */
+const Id *dnf_sack_get_evr_order(DnfSack *sack, gboolean by_arch, int *count);
+
+/**
+ * @brief Returns evr ranks of packages indexed by solvable Id. For two packages of the same name
+ *        the difference of their ranks has the sign of pool_evrcmp() of their evrs, ranks of
+ *        packages with different names are not comparable. Other solvables have rank 0. Built
+ *        and dropped together with dnf_sack_get_evr_order().
+ *
+ * @param sack p_sack:...
+ * @return const int* valid until the next change of the pool
+ */
+const int *dnf_sack_get_evr_ranks(DnfSack *sack);
+
+/**
+ * @brief Sorts package ids in the order of dnf_sack_get_evr_order(), cheaper for a few
+ *        packages than picking them from the order of the whole pool. Uses the evr ranks when
+ *        they are built already, otherwise compares evrs with pool_evrcmp() and builds nothing.
+ *
+ * @param sack p_sack:...
+ * @param ids p_ids: Package solvable ids to sort in place
+ * @param count p_count: Number of ids
+ * @param by_arch p_by_arch: Order packages of the same name by arch first
+ */
+void dnf_sack_sort_evr_order(DnfSack *sack, Id *ids, int count, gboolean by_arch);
+
+/**
+ * @brief Returns index of packages and attributes of all advisories in the pool. It is built
+ *        lazily on first use and dropped when updateinfo is loaded or the pool changes.
+ *
+ * @param sack p_sack:...
+ * @return const libdnf::AdvisoryIndex& valid until the next change of the pool
+ */
+const libdnf::AdvisoryIndex &dnf_sack_get_advisory_index(DnfSack *sack);
+
+#define DNF_SACK_QUERY_CACHE_MAX_ENTRIES 64
+
+/**
+ * @brief Returns counter that changes whenever results of queries may change: repos are loaded,
+ *        excludes or includes are modified or considered packages are recomputed.
+ *
+ * @param sack p_sack:...
+ * @return guint64
+ */
+guint64 dnf_sack_get_generation(DnfSack *sack);
+
+/**
+ * @brief Returns result of a query stored with the same key in the current sack generation
+ *
+ * @param sack p_sack:...
+ * @param key Canonical serialization of the query filters and flags
+ * @return const libdnf::PackageSet* nullptr if not cached or the cache is disabled
+ */
+const libdnf::PackageSet *dnf_sack_query_cache_lookup(DnfSack *sack, const std::string & key);
+
+/**
+ * @brief Stores copy of a query result, does nothing if the cache is disabled
+ *
+ * @param sack p_sack:...
+ * @param key Canonical serialization of the query filters and flags
+ * @param pset Result of the query
+ */
+void dnf_sack_query_cache_store(DnfSack *sack, const std::string & key,
+                                const libdnf::PackageSet & pset);
+
 void         dnf_sack_make_provides_ready   (DnfSack    *sack);
 Id           dnf_sack_running_kernel        (DnfSack    *sack);
 void         dnf_sack_recompute_considered  (DnfSack    *sack);
@@ -35,11 +35,15 @@
 #include <algorithm>
 #include <assert.h>
 #include <errno.h>
+#include <string.h>
 #include <functional>
 #include <unistd.h>
 #include <iostream>
 #include <list>
+#include <map>
 #include <set>
+#include <string>
+#include <unordered_set>
 
 extern "C" {
 #include <solv/evr.h>
@@ -66,6 +70,7 @@ extern "C" {
 
 #include "utils/bgettext/bgettext-lib.h"
 
+#include "sack/bitmap.hpp"
 #include "sack/query.hpp"
 #include "nevra.hpp"
 #include "conf/ConfigParser.hpp"
@@ -75,6 +80,7 @@ extern "C" {
 #include "module/ModulePackage.hpp"
 #include "module/modulemd/ModuleDefaultsContainer.hpp"
 #include "module/modulemd/ModuleMetadata.hpp"
+#include "module/modulemd/ModuleMetadataCache.hpp"
 #include "repo/solvable/DependencyContainer.hpp"
 #include "utils/File.hpp"
 #include "utils/utils.hpp"
@@ -94,6 +100,20 @@ typedef struct
     Map                 *module_excludes;
     Map                 *pkg_solvables;     /* Map representing only solvable pkgs of query */
     int                  pool_nsolvables;   /* Number of nsolvables for creation of pkg_solvables*/
+    Id                  *name_index;        /* offsets into name_index_data, indexed by name Id */
+    Id                  *name_index_data;   /* package solvable ids grouped by name */
+    int                  name_index_nstrings;   /* Number of pool strings covered by name_index */
+    int                  name_index_nsolvables; /* Number of nsolvables for creation of name_index */
+    libdnf::AdvisoryIndex *advisory_index;  /* NULL until first use */
+    int                  advisory_index_nsolvables; /* Number of nsolvables for creation of advisory_index */
+    Id                  *evr_order;         /* package solvable ids ordered by name, evr and id */
+    Id                  *evr_order_byarch;  /* the same ordered by name, arch, evr and id */
+    int                 *evr_ranks;         /* evr ranks of packages indexed by solvable Id */
+    int                  evr_order_count;
+    int                  evr_order_nsolvables;  /* Number of nsolvables for creation of evr_order */
+    guint64              generation;        /* bumped on every change that can alter query results */
+    std::map<std::string, libdnf::PackageSet *> *query_cache; /* NULL unless enabled */
+    guint64              query_cache_generation; /* generation the query_cache entries belong to */
     Pool                *pool;
     Queue                installonly;
     Repo                *cmdline_repo;
@@ -111,6 +131,16 @@ G_DEFINE_TYPE_WITH_PRIVATE(DnfSack, dnf_sack, G_TYPE_OBJECT)
 #define GET_PRIVATE(o) (static_cast<DnfSackPrivate *>(dnf_sack_get_instance_private (o)))
 
 
+static void
+dnf_sack_query_cache_clear(DnfSackPrivate *priv)
+{
+    if (!priv->query_cache)
+        return;
+    for (auto & entry : *priv->query_cache)
+        delete entry.second;
+    priv->query_cache->clear();
+}
+
 /**
  * dnf_sack_finalize:
  **/
@@ -139,6 +169,14 @@ dnf_sack_finalize(GObject *object)
     free_map_fully(priv->module_excludes);
     free_map_fully(pool->considered);
     free_map_fully(priv->pkg_solvables);
+    g_free(priv->name_index);
+    g_free(priv->name_index_data);
+    g_free(priv->evr_order);
+    g_free(priv->evr_order_byarch);
+    g_free(priv->evr_ranks);
+    delete priv->advisory_index;
+    dnf_sack_query_cache_clear(priv);
+    delete priv->query_cache;
     pool_free(priv->pool);
 
     G_OBJECT_CLASS(dnf_sack_parent_class)->finalize(object);
@@ -248,19 +286,6 @@ can_use_rpmdb_cache(FILE *fp_solv, unsigned char cs[CHKSUM_BYTES])
     return 0;
 }
 
-static int
-can_use_repomd_cache(FILE *fp_solv, unsigned char cs_repomd[CHKSUM_BYTES])
-{
-    unsigned char cs_cache[CHKSUM_BYTES];
-
-    if (fp_solv &&
-        !checksum_read(cs_cache, fp_solv) &&
-        !checksum_cmp(cs_cache, cs_repomd))
-        return 1;
-
-    return 0;
-}
-
 void
 dnf_sack_set_running_kernel_fn (DnfSack *sack, dnf_sack_running_kernel_fn_t fn)
 {
@@ -295,6 +320,327 @@ dnf_sack_get_pkg_solvables(DnfSack *sack)
     return new libdnf::PackageSet(sack, priv->pkg_solvables);
 }
 
+static void
+dnf_sack_invalidate_name_index(DnfSackPrivate *priv)
+{
+    g_free(priv->name_index);
+    g_free(priv->name_index_data);
+    priv->name_index = NULL;
+    priv->name_index_data = NULL;
+    priv->name_index_nstrings = 0;
+    priv->name_index_nsolvables = 0;
+}
+
+static void
+dnf_sack_build_name_index(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+    int nstrings = pool->ss.nstrings;
+    Id p;
+
+    dnf_sack_invalidate_name_index(priv);
+
+    // counting sort: name_index[name] ends up as the offset of the first solvable of that name,
+    // name_index[name + 1] as the offset behind the last one
+    auto index = g_new0(Id, nstrings + 1);
+    FOR_PKG_SOLVABLES(p)
+        index[pool->solvables[p].name]++;
+    for (int i = 1; i <= nstrings; ++i)
+        index[i] += index[i - 1];
+    auto data = g_new(Id, index[nstrings] + 1);
+    for (p = pool->nsolvables - 1; p > 1; --p) {
+        Solvable *s = pool_id2solvable(pool, p);
+        if (!s->repo || !is_package(pool, s))
+            continue;
+        data[--index[s->name]] = p;
+    }
+
+    priv->name_index = index;
+    priv->name_index_data = data;
+    priv->name_index_nstrings = nstrings;
+    priv->name_index_nsolvables = pool->nsolvables;
+}
+
+const Id *
+dnf_sack_get_name_index(DnfSack *sack, Id name, int *count)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+
+    if (!priv->name_index || priv->name_index_nsolvables != priv->pool->nsolvables)
+        dnf_sack_build_name_index(sack);
+    if (name <= 0 || name >= priv->name_index_nstrings) {
+        *count = 0;
+        return priv->name_index_data;
+    }
+    *count = priv->name_index[name + 1] - priv->name_index[name];
+    return priv->name_index_data + priv->name_index[name];
+}
+
+static int
+evr_order_cmp(const void *ap, const void *bp, void *dp)
+{
+    auto pool = static_cast<Pool *>(dp);
+    Solvable *sa = pool->solvables + *(Id *)ap;
+    Solvable *sb = pool->solvables + *(Id *)bp;
+    int r = pool_evrcmp(pool, sb->evr, sa->evr, EVRCMP_COMPARE);
+    if (r)
+        return r;
+    return *(Id *)ap - *(Id *)bp;
+}
+
+typedef struct {
+    Pool        *pool;
+    const int   *ranks;
+    gboolean     by_arch;
+} EvrRankSortData;
+
+static int
+evr_rank_cmp(const void *ap, const void *bp, void *dp)
+{
+    auto data = static_cast<EvrRankSortData *>(dp);
+    Id a = *(Id *)ap;
+    Id b = *(Id *)bp;
+    Solvable *sa = data->pool->solvables + a;
+    Solvable *sb = data->pool->solvables + b;
+    int r;
+    r = sa->name - sb->name;
+    if (r)
+        return r;
+    if (data->by_arch) {
+        r = sa->arch - sb->arch;
+        if (r)
+            return r;
+    }
+    r = data->ranks[b] - data->ranks[a];
+    if (r)
+        return r;
+    return a - b;
+}
+
+/* the order of evr_rank_cmp() for packages without ranks, evrs are compared by libsolv */
+static int
+evr_pool_cmp(const void *ap, const void *bp, void *dp)
+{
+    auto data = static_cast<EvrRankSortData *>(dp);
+    Id a = *(Id *)ap;
+    Id b = *(Id *)bp;
+    Solvable *sa = data->pool->solvables + a;
+    Solvable *sb = data->pool->solvables + b;
+    int r;
+    r = sa->name - sb->name;
+    if (r)
+        return r;
+    if (data->by_arch) {
+        r = sa->arch - sb->arch;
+        if (r)
+            return r;
+    }
+    r = pool_evrcmp(data->pool, sb->evr, sa->evr, EVRCMP_COMPARE);
+    if (r)
+        return r;
+    return a - b;
+}
+
+static void
+dnf_sack_invalidate_evr_order(DnfSackPrivate *priv)
+{
+    g_free(priv->evr_order);
+    g_free(priv->evr_order_byarch);
+    g_free(priv->evr_ranks);
+    priv->evr_order = NULL;
+    priv->evr_order_byarch = NULL;
+    priv->evr_ranks = NULL;
+    priv->evr_order_count = 0;
+    priv->evr_order_nsolvables = 0;
+}
+
+static void
+dnf_sack_build_evr_order(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+
+    dnf_sack_invalidate_evr_order(priv);
+    if (!priv->name_index || priv->name_index_nsolvables != pool->nsolvables)
+        dnf_sack_build_name_index(sack);
+
+    // the name index already groups packages by name, only packages of the same name are
+    // compared by evr
+    int nstrings = priv->name_index_nstrings;
+    const Id *index = priv->name_index;
+    int count = index[nstrings];
+    auto order = g_new(Id, count + 1);
+    memcpy(order, priv->name_index_data, count * sizeof(Id));
+    auto ranks = g_new0(int, pool->nsolvables);
+    int rank = 0;
+    for (Id name = 1; name < nstrings; ++name) {
+        int start = index[name];
+        int end = index[name + 1];
+        if (end - start > 1)
+            solv_sort(order + start, end - start, sizeof(Id), evr_order_cmp, pool);
+        // newest first, so ranks grow from the end of the block
+        for (int i = end - 1; i >= start; --i) {
+            Id evr = pool->solvables[order[i]].evr;
+            if (i == end - 1) {
+                ++rank;
+            } else {
+                Id older_evr = pool->solvables[order[i + 1]].evr;
+                if (evr != older_evr && pool_evrcmp(pool, evr, older_evr, EVRCMP_COMPARE) != 0)
+                    ++rank;
+            }
+            ranks[order[i]] = rank;
+        }
+    }
+
+    auto order_byarch = g_new(Id, count + 1);
+    memcpy(order_byarch, order, count * sizeof(Id));
+    EvrRankSortData data = {pool, ranks, TRUE};
+    for (Id name = 1; name < nstrings; ++name) {
+        if (index[name + 1] - index[name] > 1)
+            solv_sort(order_byarch + index[name], index[name + 1] - index[name], sizeof(Id),
+                      evr_rank_cmp, &data);
+    }
+
+    priv->evr_order = order;
+    priv->evr_order_byarch = order_byarch;
+    priv->evr_ranks = ranks;
+    priv->evr_order_count = count;
+    priv->evr_order_nsolvables = pool->nsolvables;
+}
+
+static void
+dnf_sack_evr_order_ready(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (!priv->evr_order || priv->evr_order_nsolvables != priv->pool->nsolvables)
+        dnf_sack_build_evr_order(sack);
+}
+
+const Id *
+dnf_sack_get_evr_order(DnfSack *sack, gboolean by_arch, int *count)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+
+    dnf_sack_evr_order_ready(sack);
+    *count = priv->evr_order_count;
+    return by_arch ? priv->evr_order_byarch : priv->evr_order;
+}
+
+const int *
+dnf_sack_get_evr_ranks(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+
+    dnf_sack_evr_order_ready(sack);
+    return priv->evr_ranks;
+}
+
+void
+dnf_sack_sort_evr_order(DnfSack *sack, Id *ids, int count, gboolean by_arch)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    Pool *pool = priv->pool;
+
+    // building the ranks orders the whole pool, a few packages are compared directly instead
+    if (!priv->evr_ranks || priv->evr_order_nsolvables != pool->nsolvables) {
+        EvrRankSortData data = {pool, NULL, by_arch};
+        solv_sort(ids, count, sizeof(Id), evr_pool_cmp, &data);
+        return;
+    }
+    EvrRankSortData data = {pool, priv->evr_ranks, by_arch};
+    solv_sort(ids, count, sizeof(Id), evr_rank_cmp, &data);
+}
+
+static void
+dnf_sack_invalidate_advisory_index(DnfSackPrivate *priv)
+{
+    delete priv->advisory_index;
+    priv->advisory_index = NULL;
+    priv->advisory_index_nsolvables = 0;
+}
+
+const libdnf::AdvisoryIndex &
+dnf_sack_get_advisory_index(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+
+    if (!priv->advisory_index || priv->advisory_index_nsolvables != priv->pool->nsolvables) {
+        dnf_sack_invalidate_advisory_index(priv);
+        priv->advisory_index = new libdnf::AdvisoryIndex(sack);
+        priv->advisory_index_nsolvables = priv->pool->nsolvables;
+    }
+    return *priv->advisory_index;
+}
+
+/**
+ * dnf_sack_get_generation: (skip)
+ * @sack: a #DnfSack instance.
+ *
+ * Returns a counter which changes whenever the set of considered packages may change,
+ * results computed for an older generation are stale.
+ *
+ * Returns: the current generation
+ */
+guint64
+dnf_sack_get_generation(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return priv->generation;
+}
+
+/**
+ * dnf_sack_query_cache_lookup: (skip)
+ * @sack: a #DnfSack instance.
+ * @key: the key of a query.
+ *
+ * Looks up the cached result of a query, the cache is emptied when the generation changes.
+ *
+ * Returns: the cached result owned by the sack, or %NULL
+ */
+const libdnf::PackageSet *
+dnf_sack_query_cache_lookup(DnfSack *sack, const std::string & key)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (!priv->query_cache)
+        return nullptr;
+    if (priv->query_cache_generation != priv->generation) {
+        dnf_sack_query_cache_clear(priv);
+        priv->query_cache_generation = priv->generation;
+        return nullptr;
+    }
+    auto it = priv->query_cache->find(key);
+    if (it == priv->query_cache->end())
+        return nullptr;
+    return it->second;
+}
+
+/**
+ * dnf_sack_query_cache_store: (skip)
+ * @sack: a #DnfSack instance.
+ * @key: the key of a query.
+ * @pset: the result of the query.
+ *
+ * Stores a copy of the result of a query for the current generation.
+ */
+void
+dnf_sack_query_cache_store(DnfSack *sack, const std::string & key, const libdnf::PackageSet & pset)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (!priv->query_cache)
+        return;
+    if (priv->query_cache_generation != priv->generation) {
+        dnf_sack_query_cache_clear(priv);
+        priv->query_cache_generation = priv->generation;
+    }
+    /* keep the memory bounded, typical users repeat only a handful of queries */
+    if (priv->query_cache->size() >= DNF_SACK_QUERY_CACHE_MAX_ENTRIES)
+        dnf_sack_query_cache_clear(priv);
+    auto & entry = (*priv->query_cache)[key];
+    delete entry;
+    entry = new libdnf::PackageSet(pset);
+}
+
 /**
  * dnf_sack_last_solvable: (skip)
  * @sack: a #DnfSack instance.
@@ -326,6 +672,7 @@ dnf_sack_recompute_considered(DnfSack *sack)
     Pool *pool = dnf_sack_get_pool(sack);
     if (priv->considered_uptodate)
         return;
+    priv->generation++;
     if (!pool->considered) {
         if (!priv->repo_excludes && !priv->module_excludes && !priv->pkg_excludes &&
             !priv->pkg_includes)
@@ -340,11 +687,11 @@ dnf_sack_recompute_considered(DnfSack *sack)
     map_setall(pool->considered);
     dnf_sack_make_provides_ready(sack);
     if (priv->repo_excludes)
-        map_subtract(pool->considered, priv->repo_excludes);
+        libdnf::bitmapSubtract(pool->considered, priv->repo_excludes);
     if (priv->pkg_excludes)
-        map_subtract(pool->considered, priv->pkg_excludes);
+        libdnf::bitmapSubtract(pool->considered, priv->pkg_excludes);
     if (priv->module_excludes)
-        map_subtract(pool->considered, priv->module_excludes);
+        libdnf::bitmapSubtract(pool->considered, priv->module_excludes);
     if (priv->pkg_includes) {
         Map pkg_includes_tmp;
         map_init_clone(&pkg_includes_tmp, priv->pkg_includes);
@@ -362,7 +709,7 @@ dnf_sack_recompute_considered(DnfSack *sack)
             }
         }
 
-        map_and(pool->considered, &pkg_includes_tmp);
+        libdnf::bitmapAnd(pool->considered, &pkg_includes_tmp);
         map_free(&pkg_includes_tmp);
     }
     priv->considered_uptodate = TRUE;
@@ -381,6 +728,10 @@ load_ext(DnfSack *sack, HyRepo hrepo, _hy_repo_repodata which_repodata,
     FILE *fp;
     gboolean done = FALSE;
 
+    /* advisories are indexed over all repos, drop the index before any of them changes */
+    if (which_repodata == _HY_REPODATA_UPDATEINFO)
+        dnf_sack_invalidate_advisory_index(priv);
+
     /* nothing set */
     if (fn == NULL) {
         g_set_error (error,
@@ -392,9 +743,9 @@ load_ext(DnfSack *sack, HyRepo hrepo, _hy_repo_repodata which_repodata,
     }
 
     char *fn_cache =  dnf_sack_give_cache_fn(sack, name, suffix);
-    fp = fopen(fn_cache, "r");
     assert(hrepo->checksum);
-    if (can_use_repomd_cache(fp, hrepo->checksum)) {
+    fp = checksum_open_matching(fn_cache, hrepo->checksum);
+    if (fp) {
         int flags = 0;
         /* the updateinfo is not a real extension */
         if (which_repodata != _HY_REPODATA_UPDATEINFO)
@@ -666,7 +1017,7 @@ load_yum_repo(DnfSack *sack, HyRepo hrepo, GError **error)
 
     FILE *fp_primary = NULL;
     FILE *fp_repomd = NULL;
-    FILE *fp_cache = fopen(fn_cache, "r");
+    FILE *fp_cache = NULL;
     if (!fn_repomd) {
         g_set_error (error,
                      DNF_ERROR,
@@ -675,8 +1026,7 @@ load_yum_repo(DnfSack *sack, HyRepo hrepo, GError **error)
         retval = FALSE;
         goto out;
     }
-    fp_repomd = fopen(fn_repomd, "r");
-    if (fp_repomd == NULL) {
+    if (checksum_fn(hrepo->checksum, fn_repomd)) {
         g_set_error (error,
                      DNF_ERROR,
                      DNF_ERROR_FILE_INVALID,
@@ -685,9 +1035,9 @@ load_yum_repo(DnfSack *sack, HyRepo hrepo, GError **error)
         retval = FALSE;
         goto out;
     }
-    checksum_fp(hrepo->checksum, fp_repomd);
 
-    if (can_use_repomd_cache(fp_cache, hrepo->checksum)) {
+    fp_cache = checksum_open_matching(fn_cache, hrepo->checksum);
+    if (fp_cache) {
         const char *chksum = pool_checksum_str(pool, hrepo->checksum);
         g_debug("using cached %s (0x%s)", name, chksum);
         if (repo_add_solv(repo, fp_cache, 0)) {
@@ -700,6 +1050,16 @@ load_yum_repo(DnfSack *sack, HyRepo hrepo, GError **error)
         }
         hrepo->state_main = _HY_LOADED_CACHE;
     } else {
+        fp_repomd = fopen(fn_repomd, "r");
+        if (fp_repomd == NULL) {
+            g_set_error (error,
+                         DNF_ERROR,
+                         DNF_ERROR_FILE_INVALID,
+                         _("can not read file %1$s: %2$s"),
+                         fn_repomd, strerror(errno));
+            retval = FALSE;
+            goto out;
+        }
         fp_primary = solv_xfopen(hy_repo_get_string(hrepo, HY_REPO_PRIMARY_FN),
                                  "r");
         assert(fp_primary);
@@ -730,6 +1090,8 @@ out:
         priv->provides_ready = 0;
     } else
         repo_free(repo, 1);
+    dnf_sack_invalidate_name_index(priv);
+    dnf_sack_invalidate_evr_order(priv);
     return retval;
 }
 
@@ -1086,6 +1448,46 @@ dnf_sack_get_installonly_limit(DnfSack *sack)
     return priv->installonly_limit;
 }
 
+/**
+ * dnf_sack_set_query_cache_enabled:
+ * @sack: a #DnfSack instance.
+ * @enabled: whether results of queries should be cached.
+ *
+ * Enables caching of query results. A query without filters on package
+ * sets that is evaluated again returns a copy of the previous result as
+ * long as no repo was loaded and no excludes or includes changed.
+ *
+ * Since: 0.16.1
+ */
+void
+dnf_sack_set_query_cache_enabled(DnfSack *sack, gboolean enabled)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    if (enabled && !priv->query_cache) {
+        priv->query_cache = new std::map<std::string, libdnf::PackageSet *>;
+        priv->query_cache_generation = priv->generation;
+    } else if (!enabled && priv->query_cache) {
+        dnf_sack_query_cache_clear(priv);
+        delete priv->query_cache;
+        priv->query_cache = NULL;
+    }
+}
+
+/**
+ * dnf_sack_get_query_cache_enabled:
+ * @sack: a #DnfSack instance.
+ *
+ * Returns: %TRUE if results of queries are cached
+ *
+ * Since: 0.16.1
+ */
+gboolean
+dnf_sack_get_query_cache_enabled(DnfSack *sack)
+{
+    DnfSackPrivate *priv = GET_PRIVATE(sack);
+    return priv->query_cache != NULL;
+}
+
 static Repo *
 dnf_sack_setup_cmdline_repo(DnfSack *sack)
 {
@@ -1123,6 +1525,9 @@ dnf_sack_add_cmdline_package_flags(DnfSack *sack, const char *fn, const int flag
     hrepo->needs_internalizing = 1;
     priv->provides_ready = 0;    /* triggers internalizing later */
     priv->considered_uptodate = FALSE;   /* triggers recompute_considered later */
+    priv->generation++;
+    dnf_sack_invalidate_name_index(priv);
+    dnf_sack_invalidate_evr_order(priv);
     return dnf_package_new(sack, p);
 }
 
@@ -1186,9 +1591,10 @@ dnf_sack_add_excludes_or_includes(DnfSack *sack, Map **dest, DnfPackageSet *pkgs
     }
 
     Map *pkgmap = dnf_packageset_get_map(pkgset);
-    map_or(destmap, pkgmap);
+    libdnf::bitmapOr(destmap, pkgmap);
     DnfSackPrivate *priv = GET_PRIVATE(sack);
     priv->considered_uptodate = FALSE;
+    priv->generation++;
 }
 
 /**
@@ -1245,9 +1651,10 @@ dnf_sack_remove_excludes_or_includes(DnfSack *sack, Map *from, DnfPackageSet *pk
     if (from == NULL)
         return;
     Map *pkgmap = dnf_packageset_get_map(pkgset);
-    map_subtract(from, pkgmap);
+    libdnf::bitmapSubtract(from, pkgmap);
     DnfSackPrivate *priv = GET_PRIVATE(sack);
     priv->considered_uptodate = FALSE;
+    priv->generation++;
 }
 
 /**
@@ -1312,6 +1719,7 @@ dnf_sack_set_excludes_or_includes(DnfSack *sack, Map **dest, DnfPackageSet *pkgs
     }
     DnfSackPrivate *priv = GET_PRIVATE(sack);
     priv->considered_uptodate = FALSE;
+    priv->generation++;
 }
 
 /**
@@ -1480,6 +1888,7 @@ dnf_sack_set_use_includes(DnfSack *sack, const char *reponame, gboolean enabled)
         {
             hy_repo_set_use_includes(hyrepo, enabled);
             priv->considered_uptodate = FALSE;
+            priv->generation++;
         }
     } else {
         Id repoid;
@@ -1490,6 +1899,7 @@ dnf_sack_set_use_includes(DnfSack *sack, const char *reponame, gboolean enabled)
             {
                 hy_repo_set_use_includes(hyrepo, enabled);
                 priv->considered_uptodate = FALSE;
+                priv->generation++;
             }
         }
     }
@@ -1558,6 +1968,59 @@ dnf_sack_repo_enabled(DnfSack *sack, const char *reponame, int enabled)
         FOR_REPO_SOLVABLES(repo, p, s)
             MAPCLR(priv->repo_excludes, p);
     priv->considered_uptodate = FALSE;
+    priv->generation++;
+    return 0;
+}
+
+/* Reads the rpmdb into repo using the previous @System.solv (if any) as
+ * a reference, with the same steps and flags as repo_add_rpmdb_reffp().
+ * It is done here to be able to log how many packages of the rpmdb were
+ * matched by their rpmdb id in the reference. */
+static int
+load_rpmdb_incremental(Pool *pool, Repo *repo, FILE *ref_fp)
+{
+    int flagsrpm = REPO_REUSE_REPODATA | RPM_ADD_WITH_HDRID | REPO_USE_ROOTDIR;
+    Repo *ref = NULL;
+    int rc;
+
+    if (ref_fp == NULL) {
+        g_debug("no rpmdb cache, reading all headers");
+        return repo_add_rpmdb(repo, NULL, flagsrpm);
+    }
+#ifdef ADD_NO_AUTOPRODUCTS
+    /* given whenever there is a cache file, even one that fails to load */
+    flagsrpm |= ADD_NO_AUTOPRODUCTS;
+#endif
+    ref = repo_create(pool, "add_rpmdb_reffp");
+    if (repo_add_solv(ref, ref_fp, 0) != 0 || ref->start == ref->end) {
+        repo_free(ref, 1);
+        g_debug("no usable rpmdb cache, reading all headers");
+        return repo_add_rpmdb(repo, NULL, flagsrpm);
+    }
+    repo_disable_paging(ref);
+
+    std::unordered_set<unsigned long long> ref_ids;
+    ref_ids.reserve(ref->nsolvables);
+    Id p;
+    Solvable *s;
+    FOR_REPO_SOLVABLES(ref, p, s)
+        ref_ids.insert(repo_lookup_num(ref, p, RPM_RPMDBID, 0));
+
+    rc = repo_add_rpmdb(repo, ref, flagsrpm);
+    repo_free(ref, 1);
+    if (rc)
+        return rc;
+
+    int matched = 0;
+    int unmatched = 0;
+    FOR_REPO_SOLVABLES(repo, p, s) {
+        if (ref_ids.count(repo_lookup_num(repo, p, RPM_RPMDBID, 0)))
+            matched++;
+        else
+            unmatched++;
+    }
+    g_debug("rpmdb: %d packages matched by rpmdb id in the cache, %d not, %d cached ids gone",
+            matched, unmatched, (int) ref_ids.size() - matched);
     return 0;
 }
 
@@ -1613,13 +2076,14 @@ dnf_sack_load_system_repo(DnfSack *sack, HyRepo a_hrepo, int flags, GError **err
             hrepo->state_main = _HY_LOADED_CACHE;
     } else {
         g_debug("fetching rpmdb");
-        int flagsrpm = REPO_REUSE_REPODATA | RPM_ADD_WITH_HDRID | REPO_USE_ROOTDIR;
-        rc = repo_add_rpmdb_reffp(repo, cache_fp, flagsrpm);
+        rc = load_rpmdb_incremental(pool, repo, cache_fp);
         if (!rc)
             hrepo->state_main = _HY_LOADED_FETCH;
     }
     if (rc) {
         repo_free(repo, 1);
+        dnf_sack_invalidate_name_index(priv);
+        dnf_sack_invalidate_evr_order(priv);
         ret = FALSE;
         g_set_error (error,
                      DNF_ERROR,
@@ -1631,6 +2095,8 @@ dnf_sack_load_system_repo(DnfSack *sack, HyRepo a_hrepo, int flags, GError **err
     repo_finalize_init(hrepo, repo);
     pool_set_installed(pool, repo);
     priv->provides_ready = 0;
+    dnf_sack_invalidate_name_index(priv);
+    dnf_sack_invalidate_evr_order(priv);
 
     if (hrepo->state_main == _HY_LOADED_FETCH && build_cache) {
         ret = write_main(sack, hrepo, 1, error);
@@ -1642,6 +2108,7 @@ dnf_sack_load_system_repo(DnfSack *sack, HyRepo a_hrepo, int flags, GError **err
     hrepo->main_nrepodata = repo->nrepodata;
     hrepo->main_end = repo->end;
     priv->considered_uptodate = FALSE;
+    priv->generation++;
 
  finish:
     if (cache_fp)
@@ -1746,6 +2213,7 @@ dnf_sack_load_repo(DnfSack *sack, HyRepo repo, int flags, GError **error)
                 return FALSE;
     }
     priv->considered_uptodate = FALSE;
+    priv->generation++;
     return TRUE;
 }
 
@@ -1923,44 +2391,30 @@ process_excludes(DnfSack *sack, DnfRepo *repo)
     }
 }
 
-/**
- * dnf_sack_add_repo:
- */
-gboolean
-dnf_sack_add_repo(DnfSack *sack,
-                    DnfRepo *repo,
-                    guint permissible_cache_age,
-                    DnfSackAddFlags flags,
-                    DnfState *state,
-                    GError **error)
+/* returns FALSE on error, @usable is set to FALSE if the repo should be skipped */
+static gboolean
+check_repo(DnfRepo *repo,
+           guint permissible_cache_age,
+           DnfState *state,
+           gboolean *usable,
+           GError **error)
 {
-    gboolean ret = TRUE;
+    gboolean ret;
     GError *error_local = NULL;
-    DnfState *state_local;
-    int flags_hy = DNF_SACK_LOAD_FLAG_BUILD_CACHE;
 
-    /* set state */
-    ret = dnf_state_set_steps(state, error,
-                   5, /* check repo */
-                   95, /* load solv */
-                   -1);
-    if (!ret)
-        return FALSE;
-
-    /* check repo */
-    state_local = dnf_state_get_child(state);
+    *usable = TRUE;
     ret = dnf_repo_check(repo,
                          permissible_cache_age,
-                         state_local,
+                         state,
                          &error_local);
     if (!ret) {
         g_debug("failed to check, attempting update: %s",
                 error_local->message);
         g_clear_error(&error_local);
-        dnf_state_reset(state_local);
+        dnf_state_reset(state);
         ret = dnf_repo_update(repo,
                               DNF_REPO_UPDATE_FLAG_FORCE,
-                              state_local,
+                              state,
                               &error_local);
         if (!ret) {
             if (!dnf_repo_get_required(repo) &&
@@ -1971,7 +2425,8 @@ dnf_sack_add_repo(DnfSack *sack,
                           dnf_repo_get_id(repo),
                           error_local->message);
                 g_error_free(error_local);
-                return dnf_state_finished(state, error);
+                *usable = FALSE;
+                return TRUE;
             }
             g_propagate_error(error, error_local);
             return FALSE;
@@ -1982,12 +2437,15 @@ dnf_sack_add_repo(DnfSack *sack,
     if (dnf_repo_get_enabled(repo) == DNF_REPO_ENABLED_NONE) {
         g_debug("Skipping %s as repo no longer enabled",
                 dnf_repo_get_id(repo));
-        return dnf_state_finished(state, error);
+        *usable = FALSE;
     }
+    return TRUE;
+}
 
-    /* done */
-    if (!dnf_state_done(state, error))
-        return FALSE;
+static gboolean
+load_checked_repo(DnfSack *sack, DnfRepo *repo, DnfSackAddFlags flags, GError **error)
+{
+    int flags_hy = DNF_SACK_LOAD_FLAG_BUILD_CACHE;
 
     /* only load what's required */
     if ((flags & DNF_SACK_ADD_FLAG_FILELISTS) > 0)
@@ -1995,16 +2453,231 @@ dnf_sack_add_repo(DnfSack *sack,
     if ((flags & DNF_SACK_ADD_FLAG_UPDATEINFO) > 0)
         flags_hy |= DNF_SACK_LOAD_FLAG_USE_UPDATEINFO;
 
-    /* load solv */
     g_debug("Loading repo %s", dnf_repo_get_id(repo));
+    return dnf_sack_load_repo(sack, dnf_repo_get_repo(repo), flags_hy, error);
+}
+
+/**
+ * dnf_sack_add_repo:
+ */
+gboolean
+dnf_sack_add_repo(DnfSack *sack,
+                    DnfRepo *repo,
+                    guint permissible_cache_age,
+                    DnfSackAddFlags flags,
+                    DnfState *state,
+                    GError **error)
+{
+    gboolean ret = TRUE;
+    gboolean usable;
+    DnfState *state_local;
+
+    /* set state */
+    ret = dnf_state_set_steps(state, error,
+                   5, /* check repo */
+                   95, /* load solv */
+                   -1);
+    if (!ret)
+        return FALSE;
+
+    /* check repo */
+    state_local = dnf_state_get_child(state);
+    if (!check_repo(repo, permissible_cache_age, state_local, &usable, error))
+        return FALSE;
+    if (!usable)
+        return dnf_state_finished(state, error);
+
+    /* done */
+    if (!dnf_state_done(state, error))
+        return FALSE;
+
+    /* load solv */
     dnf_state_action_start(state, DNF_STATE_ACTION_LOADING_CACHE, NULL);
-    if (!dnf_sack_load_repo(sack, dnf_repo_get_repo(repo), flags_hy, error))
+    if (!load_checked_repo(sack, repo, flags, error))
         return FALSE;
 
     /* done */
     return dnf_state_done(state, error);
 }
 
+typedef struct {
+    gchar   *name;
+    gchar   *fn_repomd;
+    gchar   *fn_primary;
+    gchar   *fn_cache;
+} DnfSackPrebuildJob;
+
+static void
+dnf_sack_prebuild_job_free(DnfSackPrebuildJob *job)
+{
+    g_free(job->name);
+    g_free(job->fn_repomd);
+    g_free(job->fn_primary);
+    g_free(job->fn_cache);
+    g_free(job);
+}
+
+/* Writes @repo and @checksum to a temporary file moved over @fn_cache, as
+ * write_main() does, without any error reporting. */
+static gboolean
+prebuild_write_main(Repo *repo, const unsigned char *checksum, const char *fn_cache)
+{
+    g_autofree gchar *tmp_fn_templ = solv_dupjoin(fn_cache, ".XXXXXX", NULL);
+    int tmp_fd = mkstemp(tmp_fn_templ);
+    if (tmp_fd < 0)
+        return FALSE;
+    FILE *fp = fdopen(tmp_fd, "w+");
+    if (fp == NULL) {
+        close(tmp_fd);
+        unlink(tmp_fn_templ);
+        return FALSE;
+    }
+    int rc = repo_write(repo, fp);
+    rc |= checksum_write(checksum, fp);
+    rc |= fclose(fp);
+    if (rc || !mv(tmp_fn_templ, fn_cache, NULL)) {
+        unlink(tmp_fn_templ);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* Runs in a worker thread: parses primary of one repo into a private pool and
+ * writes the main solv cache, the same file write_main() would produce. The
+ * shared pool is not touched, loading the cache is left to the caller. Any
+ * failure is not fatal, the repo is then parsed again by load_yum_repo(). */
+static void
+prebuild_main_cache_cb(gpointer data, gpointer user_data)
+{
+    auto job = static_cast<DnfSackPrebuildJob *>(data);
+    unsigned char checksum[CHKSUM_BYTES];
+
+    if (checksum_fn(checksum, job->fn_repomd))
+        return;
+    FILE *fp_cache = checksum_open_matching(job->fn_cache, checksum);
+    if (fp_cache) {
+        fclose(fp_cache);
+        return;
+    }
+
+    FILE *fp_repomd = fopen(job->fn_repomd, "r");
+    FILE *fp_primary = solv_xfopen(job->fn_primary, "r");
+    if (fp_repomd != NULL && fp_primary != NULL) {
+        g_debug("fetching %s in worker thread", job->name);
+        Pool *pool = pool_create();
+        Repo *repo = repo_create(pool, job->name);
+        if (repo_add_repomdxml(repo, fp_repomd, 0) ||
+            repo_add_rpmmd(repo, fp_primary, 0, 0))
+            g_debug("failed to parse %s in worker thread: %s",
+                    job->name, pool_errstr(pool));
+        else if (!prebuild_write_main(repo, checksum, job->fn_cache))
+            g_debug("failed to write cache of %s in worker thread", job->name);
+        pool_free(pool);
+    }
+    if (fp_primary)
+        fclose(fp_primary);
+    if (fp_repomd)
+        fclose(fp_repomd);
+}
+
+/* Checks the repos one by one, parses those with a stale main cache
+ * concurrently and then loads everything into the shared pool in the order
+ * of @repos, so the result does not depend on thread scheduling. */
+static gboolean
+add_repos_parallel(DnfSack *sack,
+                   GPtrArray *repos,
+                   guint permissible_cache_age,
+                   DnfSackAddFlags flags,
+                   GPtrArray *enabled_repos,
+                   DnfState *state,
+                   GError **error)
+{
+    DnfState *state_local;
+    DnfState *state_loop;
+    DnfRepo *repo;
+    gboolean usable;
+    guint i;
+    g_autoptr(GPtrArray) checked_repos = g_ptr_array_new();
+    g_autoptr(GPtrArray) jobs = g_ptr_array_new_with_free_func((GDestroyNotify) dnf_sack_prebuild_job_free);
+
+    /* set state */
+    if (!dnf_state_set_steps(state, error,
+                             10, /* check repos */
+                             60, /* parse repos */
+                             30, /* load solv */
+                             -1))
+        return FALSE;
+
+    /* check repos, this may download metadata so keep it sequential */
+    state_local = dnf_state_get_child(state);
+    dnf_state_set_number_steps(state_local, repos->len);
+    for (i = 0; i < repos->len; i++) {
+        repo = static_cast<DnfRepo *>(g_ptr_array_index(repos, i));
+        state_loop = dnf_state_get_child(state_local);
+        if (!check_repo(repo, permissible_cache_age, state_loop, &usable, error))
+            return FALSE;
+        if (usable)
+            g_ptr_array_add(checked_repos, repo);
+        if (!dnf_state_done(state_local, error))
+            return FALSE;
+    }
+    if (!dnf_state_done(state, error))
+        return FALSE;
+
+    /* parse stale repos on a worker pool, each into its own libsolv pool */
+    state_local = dnf_state_get_child(state);
+    if (!dnf_state_set_steps(state_local, error,
+                             5, /* collect jobs */
+                             95, /* run jobs */
+                             -1))
+        return FALSE;
+    dnf_state_action_start(state_local, DNF_STATE_ACTION_LOADING_CACHE, NULL);
+    for (i = 0; i < checked_repos->len; i++) {
+        repo = static_cast<DnfRepo *>(g_ptr_array_index(checked_repos, i));
+        HyRepo hrepo = dnf_repo_get_repo(repo);
+        const char *fn_repomd = hy_repo_get_string(hrepo, HY_REPO_MD_FN);
+        const char *fn_primary = hy_repo_get_string(hrepo, HY_REPO_PRIMARY_FN);
+        if (fn_repomd == NULL || fn_primary == NULL)
+            continue;
+        auto job = g_new0(DnfSackPrebuildJob, 1);
+        job->name = g_strdup(hy_repo_get_string(hrepo, HY_REPO_NAME));
+        job->fn_repomd = g_strdup(fn_repomd);
+        job->fn_primary = g_strdup(fn_primary);
+        job->fn_cache = dnf_sack_give_cache_fn(sack, job->name, NULL);
+        g_ptr_array_add(jobs, job);
+    }
+    if (!dnf_state_done(state_local, error))
+        return FALSE;
+    if (jobs->len > 1) {
+        gint max_threads = MIN(g_get_num_processors(), (guint) jobs->len);
+        GThreadPool *pool = g_thread_pool_new(prebuild_main_cache_cb, NULL,
+                                              max_threads, TRUE, NULL);
+        if (pool != NULL) {
+            for (i = 0; i < jobs->len; i++)
+                g_thread_pool_push(pool, g_ptr_array_index(jobs, i), NULL);
+            /* wait for all the jobs to finish */
+            g_thread_pool_free(pool, FALSE, TRUE);
+        }
+    }
+    if (!dnf_state_done(state_local, error))
+        return FALSE;
+    if (!dnf_state_done(state, error))
+        return FALSE;
+
+    /* load in the original order, the caches are up to date now */
+    state_local = dnf_state_get_child(state);
+    dnf_state_set_number_steps(state_local, checked_repos->len);
+    for (i = 0; i < checked_repos->len; i++) {
+        repo = static_cast<DnfRepo *>(g_ptr_array_index(checked_repos, i));
+        if (!load_checked_repo(sack, repo, flags, error))
+            return FALSE;
+        g_ptr_array_add(enabled_repos, repo);
+        if (!dnf_state_done(state_local, error))
+            return FALSE;
+    }
+    return dnf_state_done(state, error);
+}
+
 /**
  * dnf_sack_add_repos:
  */
@@ -2017,11 +2690,11 @@ dnf_sack_add_repos(DnfSack *sack,
                      GError **error)
 {
     gboolean ret;
-    guint cnt = 0;
     guint i;
     DnfRepo *repo;
     DnfState *state_local;
     g_autoptr(GPtrArray) enabled_repos = g_ptr_array_new();
+    g_autoptr(GPtrArray) repos_to_add = g_ptr_array_new();
 
     /* count the enabled repos */
     for (i = 0; i < repos->len; i++) {
@@ -2035,37 +2708,34 @@ dnf_sack_add_repos(DnfSack *sack,
                 continue;
         }
 
-        cnt++;
+        g_ptr_array_add(repos_to_add, repo);
     }
 
-    /* add each repo */
-    dnf_state_set_number_steps(state, cnt);
-    for (i = 0; i < repos->len; i++) {
-        repo = static_cast<DnfRepo *>(g_ptr_array_index(repos, i));
-        if (dnf_repo_get_enabled(repo) == DNF_REPO_ENABLED_NONE)
-            continue;
-
-        /* only allow metadata-only repos if FLAG_UNAVAILABLE is set */
-        if (dnf_repo_get_enabled(repo) == DNF_REPO_ENABLED_METADATA) {
-            if ((flags & DNF_SACK_ADD_FLAG_UNAVAILABLE) == 0)
-                continue;
-        }
-
-        state_local = dnf_state_get_child(state);
-        ret = dnf_sack_add_repo(sack,
-                                  repo,
-                                  permissible_cache_age,
-                                  flags,
-                                  state_local,
-                                  error);
-        if (!ret)
+    if ((flags & DNF_SACK_ADD_FLAG_PARALLEL) > 0 && repos_to_add->len > 1) {
+        if (!add_repos_parallel(sack, repos_to_add, permissible_cache_age,
+                                flags, enabled_repos, state, error))
             return FALSE;
+    } else {
+        /* add each repo */
+        dnf_state_set_number_steps(state, repos_to_add->len);
+        for (i = 0; i < repos_to_add->len; i++) {
+            repo = static_cast<DnfRepo *>(g_ptr_array_index(repos_to_add, i));
+            state_local = dnf_state_get_child(state);
+            ret = dnf_sack_add_repo(sack,
+                                      repo,
+                                      permissible_cache_age,
+                                      flags,
+                                      state_local,
+                                      error);
+            if (!ret)
+                return FALSE;
 
-        g_ptr_array_add(enabled_repos, repo);
+            g_ptr_array_add(enabled_repos, repo);
 
-        /* done */
-        if (!dnf_state_done(state, error))
-            return FALSE;
+            /* done */
+            if (!dnf_state_done(state, error))
+                return FALSE;
+        }
     }
 
     for (i = 0; i < enabled_repos->len; i++) {
@@ -2112,24 +2782,61 @@ std::string getFileContent(const std::string &filePath)
     return yamlContent;
 }
 
-void createConflictsBetweenStreams(const std::map<Id, std::shared_ptr<ModulePackage>> &modules)
+void writeModuleMetadataCache(const char *fn, const unsigned char *checksum, GPtrArray *data)
+{
+    g_autofree gchar *tmp_fn_templ = g_strconcat(fn, ".XXXXXX", NULL);
+    int tmp_fd = mkstemp(tmp_fn_templ);
+    if (tmp_fd < 0) {
+        g_debug("%s: cannot create temporary file: %s", __func__, tmp_fn_templ);
+        return;
+    }
+    FILE *fp = fdopen(tmp_fd, "w+");
+    if (!fp) {
+        close(tmp_fd);
+        unlink(tmp_fn_templ);
+        return;
+    }
+
+    int rc = ModuleMetadataCache::write(data, fp) ? 0 : 1;
+    rc |= checksum_write(checksum, fp);
+    rc |= fclose(fp);
+    g_autoptr(GError) error = nullptr;
+    if (rc || !mv(tmp_fn_templ, fn, &error)) {
+        g_debug("%s: failed writing module cache: %s", __func__, fn);
+        unlink(tmp_fn_templ);
+    }
+}
+
+/**
+ * @brief Returns modules and module defaults of the repo. They are loaded from the module cache
+ * when it was written for the same repomd.xml, otherwise the modules yaml is parsed and the
+ * cache is rewritten. The caller owns the returned array, it is nullptr if nothing was parsed.
+ */
+GPtrArray * loadModuleMetadata(DnfSack *sack, DnfRepo *repo, const char *modules_fn)
 {
-    // TODO Use libdnf::Query for filtering
-    for (const auto &iter : modules) {
-        const auto &modulePackage = iter.second;
+    HyRepo hrepo = dnf_repo_get_repo(repo);
+    const char *name = hy_repo_get_string(hrepo, HY_REPO_NAME);
+    g_autofree gchar *fn_cache = dnf_sack_give_cache_fn(sack, name, HY_EXT_MODULES);
 
-        for (const auto &innerIter : modules) {
-            if (modulePackage->getName() == innerIter.second->getName()
-                && modulePackage->getStream() != innerIter.second->getStream()) {
-                modulePackage->addStreamConflict(innerIter.second);
-            }
+    FILE *fp = checksum_open_matching(fn_cache, hrepo->checksum);
+    if (fp) {
+        GPtrArray *data = ModuleMetadataCache::read(fp);
+        fclose(fp);
+        if (data) {
+            g_debug("%s: using cache file: %s", __func__, fn_cache);
+            return data;
         }
     }
+
+    GPtrArray *data = ModuleMetadata::objectsFromString(getFileContent(modules_fn));
+    if (data)
+        writeModuleMetadataCache(fn_cache, hrepo->checksum, data);
+    return data;
 }
 
-void readModuleMetadataFromRepo(const GPtrArray *repos, ModulePackageContainer & modulePackages,
-    ModuleDefaultsContainer & moduleDefaults, const char * install_root,
-    const char * platformModule)
+void readModuleMetadataFromRepo(DnfSack *sack, const GPtrArray *repos,
+    ModulePackageContainer & modulePackages, ModuleDefaultsContainer & moduleDefaults,
+    const char * install_root, const char * platformModule)
 {
     auto pool = modulePackages.getPool();
 
@@ -2138,20 +2845,20 @@ void readModuleMetadataFromRepo(const GPtrArray *repos, ModulePackageContainer &
         auto modules_fn = dnf_repo_get_filename_md(repo, "modules");
         if (modules_fn == nullptr)
             continue;
-        std::string yamlContent = getFileContent(modules_fn);
-
-        auto modules = ModulePackageMaker::fromString(pool.get(), dnf_repo_get_repo(repo), yamlContent);
-        createConflictsBetweenStreams(modules);
+        g_autoptr(GPtrArray) data = loadModuleMetadata(sack, repo, modules_fn);
 
+        auto modules = ModulePackageMaker::fromObjects(pool.get(), dnf_repo_get_repo(repo), data);
         modulePackages.add(modules);
 
         // update defaults from repo
         try {
-            moduleDefaults.fromString(yamlContent, 0);
+            moduleDefaults.fromObjects(data, 0);
         } catch (ModuleDefaultsContainer::ConflictException &exception) {
             // TODO logger.warning(exception.what());
         }
     }
+    modulePackages.createConflictsBetweenStreams();
+
     // TODO remove hard-coded path
     try {
         createPlatformSolvable(pool.get(), "/etc/os-release", install_root, platformModule);
@@ -2179,10 +2886,15 @@ std::tuple<std::vector<std::string>, std::vector<std::string>> collectNevraForIn
     std::vector<std::string> includeNEVRAs;
     std::vector<std::string> excludeNEVRAs;
 
+    std::unordered_set<Id> activeIds;
+    for (const auto &module : activeModulePackages) {
+        activeIds.insert(module->getId());
+    }
+
     // TODO: turn into std::vector<const char *> to prevent unecessary conversion?
     for (const auto &module : modulePackageContainer.getModulePackages()) {
         auto artifacts = module->getArtifacts();
-        if (std::find(begin(activeModulePackages), end(activeModulePackages), module) != end(activeModulePackages)) {
+        if (activeIds.count(module->getId())) {
             copy(std::begin(artifacts), std::end(artifacts), std::back_inserter(includeNEVRAs));
         } else {
             copy(std::begin(artifacts), std::end(artifacts), std::back_inserter(excludeNEVRAs));
@@ -2251,7 +2963,7 @@ void dnf_sack_filter_modules(DnfSack *sack, GPtrArray *repos, const char *instal
     ModulePackageContainer modulePackages{std::shared_ptr<Pool>(pool_create(), &pool_free), priv->arch};
     ModuleDefaultsContainer moduleDefaults;
 
-    readModuleMetadataFromRepo(repos, modulePackages, moduleDefaults, install_root, platformModule);
+    readModuleMetadataFromRepo(sack, repos, modulePackages, moduleDefaults, install_root, platformModule);
     readModuleDefaultsFromDisk(defaultsDirPath, moduleDefaults);
 
     try {
@@ -113,6 +113,9 @@ void         dnf_sack_set_installonly       (DnfSack        *sack,
 void         dnf_sack_set_installonly_limit (DnfSack        *sack,
                                              guint           limit);
 guint        dnf_sack_get_installonly_limit (DnfSack        *sack);
+void         dnf_sack_set_query_cache_enabled (DnfSack      *sack,
+                                             gboolean        enabled);
+gboolean     dnf_sack_get_query_cache_enabled (DnfSack      *sack);
 DnfPackage  *dnf_sack_add_cmdline_package   (DnfSack        *sack,
                                              const char     *fn);
 DnfPackage  *dnf_sack_add_cmdline_package_nochecksum   (DnfSack        *sack,
@@ -174,6 +177,7 @@ void dnf_sack_filter_modules(DnfSack *sack, GPtrArray *repos, const char *instal
  * @DNF_SACK_ADD_FLAG_UPDATEINFO:               Add the updateinfo
  * @DNF_SACK_ADD_FLAG_REMOTE:                   Use remote repos
  * @DNF_SACK_ADD_FLAG_UNAVAILABLE:              Add repos that are unavailable
+ * @DNF_SACK_ADD_FLAG_PARALLEL:                 Parse repos with stale caches concurrently
  *
  * Flags to control repo loading into the sack.
  **/
@@ -183,6 +187,7 @@ typedef enum {
         DNF_SACK_ADD_FLAG_UPDATEINFO            = 2,
         DNF_SACK_ADD_FLAG_REMOTE                = 4,
         DNF_SACK_ADD_FLAG_UNAVAILABLE           = 8,
+        DNF_SACK_ADD_FLAG_PARALLEL              = 16,
         /*< private >*/
         DNF_SACK_ADD_FLAG_LAST
 } DnfSackAddFlags;
@@ -28,6 +28,10 @@
  * This object represents an RPM transaction.
  */
 
+#include <map>
+#include <utility>
+#include <vector>
+
 #include <rpm/rpmlib.h>
 #include <rpm/rpmlog.h>
 #include <rpm/rpmts.h>
@@ -818,21 +822,48 @@ _get_current_time()
  * avoid the lookup in the rpmdb.
  **/
 static void
-_history_write_item(DnfPackage *pkg, libdnf::Swdb *swdb, libdnf::TransactionItemAction action)
+_history_write_items(
+    const std::vector< std::pair< DnfPackage *, libdnf::TransactionItemAction > > &items,
+    libdnf::Swdb *swdb)
 {
-    auto rpm = swdb->createRPMItem();
-    rpm->setName(dnf_package_get_name(pkg));
-    rpm->setEpoch(dnf_package_get_epoch(pkg));
-    rpm->setVersion(dnf_package_get_version(pkg));
-    rpm->setRelease(dnf_package_get_release(pkg));
-    rpm->setArch(dnf_package_get_arch(pkg));
-    rpm->save();
-
-    libdnf::TransactionItemReason reason =
-        swdb->resolveRPMTransactionItemReason(rpm->getName(), rpm->getArch(), -2);
-
-    auto transItem = swdb->addItem(
-        std::dynamic_pointer_cast< libdnf::Item >(rpm), dnf_package_get_reponame(pkg), action, reason);
+    auto conn = swdb->getConn();
+    std::vector< libdnf::RPMItemPtr > rpms;
+    rpms.reserve(items.size());
+    for (const auto &item : items) {
+        auto rpm = swdb->createRPMItem();
+        rpm->setName(dnf_package_get_name(item.first));
+        rpm->setEpoch(dnf_package_get_epoch(item.first));
+        rpm->setVersion(dnf_package_get_version(item.first));
+        rpm->setRelease(dnf_package_get_release(item.first));
+        rpm->setArch(dnf_package_get_arch(item.first));
+        rpms.push_back(rpm);
+    }
+    libdnf::RPMItem::saveNew(conn, rpms);
+
+    // reasons of all packages at once; as in Swdb::resolveRPMTransactionItemReason(), items
+    // already in the transaction take precedence over the history
+    auto reasons = libdnf::RPMItem::resolveTransactionItemReasons(conn);
+    std::map< std::pair< std::string, std::string >, libdnf::TransactionItemReason > inProgress;
+    for (const auto &transItem : swdb->getItems()) {
+        auto rpm = std::dynamic_pointer_cast< libdnf::RPMItem >(transItem->getItem());
+        if (rpm)
+            inProgress.emplace(std::make_pair(rpm->getName(), rpm->getArch()),
+                               transItem->getReason());
+    }
+    for (const auto &it : inProgress)
+        reasons[it.first] = it.second;
+
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        auto &rpm = rpms[i];
+        auto reasonIt = reasons.find(std::make_pair(rpm->getName(), rpm->getArch()));
+        libdnf::TransactionItemReason reason = reasonIt == reasons.end()
+                                                   ? libdnf::TransactionItemReason::UNKNOWN
+                                                   : reasonIt->second;
+        swdb->addItem(std::dynamic_pointer_cast< libdnf::Item >(rpm),
+                      dnf_package_get_reponame(items[i].first),
+                      items[i].second,
+                      reason);
+    }
 }
 
 static gboolean
@@ -1084,6 +1115,7 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
     rpmtransFlags rpmts_flags = RPMTRANS_FLAG_NONE;
     DnfTransactionPrivate *priv = GET_PRIVATE(transaction);
     libdnf::Swdb *swdb = priv->swdb;
+    std::vector< std::pair< DnfPackage *, libdnf::TransactionItemAction > > history_items;
 
     /* take lock */
     ret = dnf_state_take_lock(state, DNF_LOCK_TYPE_RPMDB, DNF_LOCK_MODE_PROCESS, error);
@@ -1179,8 +1211,8 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
             swdbAction = libdnf::TransactionItemAction::REINSTALL;
         }
 
-        // add item to swdb transaction
-        _history_write_item(pkg, priv->swdb, swdbAction);
+        // add item to swdb transaction, it is written together with the transaction
+        history_items.emplace_back(pkg, swdbAction);
 
         /* this section done */
         ret = dnf_state_done(state_local, error);
@@ -1220,7 +1252,7 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
                 swdbAction = libdnf::TransactionItemAction::DOWNGRADED;
             }
         }
-        _history_write_item(pkg, priv->swdb, swdbAction);
+        history_items.emplace_back(pkg, swdbAction);
     }
 
     /* add anything that gets obsoleted to a helper array which is used to
@@ -1259,7 +1291,7 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
             }
 
             // TODO SWDB add pkg_tmp replaced_by pkg
-            _history_write_item(pkg_tmp, priv->swdb, swdbAction);
+            history_items.emplace_back(pkg_tmp, swdbAction);
         }
         g_ptr_array_unref(pkglist);
     }
@@ -1360,8 +1392,14 @@ dnf_transaction_commit(DnfTransaction *transaction, HyGoal goal, DnfState *state
         goto out;
     }
 
-    // FIXME get commandline and rpmdb version
-    swdb->beginTransaction(_get_current_time(), "", "", priv->uid);
+    // write the items and the transaction to the history database in one SQLite transaction
+    {
+        SQLite3::TransactionGuard history_guard(*swdb->getConn());
+        _history_write_items(history_items, swdb);
+        // FIXME get commandline and rpmdb version
+        swdb->beginTransaction(_get_current_time(), "", "", priv->uid);
+        history_guard.commit();
+    }
 
     /* run the transaction */
     priv->state = dnf_state_get_child(state);
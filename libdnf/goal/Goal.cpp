@@ -338,6 +338,7 @@ namespace libdnf {
 struct InstallonliesSortCallback {
     Pool *pool;
     Id running_kernel;
+    const int *evr_ranks;
 };
 
 static inline void
@@ -400,7 +401,8 @@ sort_packages(const void *ap, const void *bp, void *s_cb)
             return -1;
     }
 
-    return pool_evrcmp(pool, sa->evr, sb->evr, EVRCMP_COMPARE);
+    const int *ranks = ((struct InstallonliesSortCallback*) s_cb)->evr_ranks;
+    return ranks[a] - ranks[b];
 }
 
 static void
@@ -1046,7 +1048,8 @@ Goal::Impl::limitInstallonlyPackages(Solver *solv, Queue *job)
             continue;
         }
 
-        struct InstallonliesSortCallback s_cb = {pool, dnf_sack_running_kernel(sack)};
+        struct InstallonliesSortCallback s_cb = {pool, dnf_sack_running_kernel(sack),
+                                                 dnf_sack_get_evr_ranks(sack)};
         solv_sort(q.data(), q.size(), sizeof(q[0]), sort_packages, &s_cb);
         IdQueue same_names;
         while (q.size() > 0) {
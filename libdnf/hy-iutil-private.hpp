@@ -28,6 +28,8 @@
 /* crypto utils */
 int checksum_cmp(const unsigned char *cs1, const unsigned char *cs2);
 int checksum_fp(unsigned char *out, FILE *fp);
+int checksum_fn(unsigned char *out, const char *fn);
+FILE *checksum_open_matching(const char *fn, const unsigned char *cs);
 int checksum_read(unsigned char *csout, FILE *fp);
 int checksum_stat(unsigned char *out, FILE *fp);
 int checksum_write(const unsigned char *cs, FILE *fp);
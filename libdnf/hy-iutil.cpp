@@ -26,6 +26,7 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/utsname.h>
@@ -131,6 +132,62 @@ checksum_fp(unsigned char *out, FILE *fp)
     return 0;
 }
 
+/* same as checksum_fp() but reads the file through a read-only mapping */
+int
+checksum_fn(unsigned char *out, const char *fn)
+{
+    struct stat stat;
+    void *addr = NULL;
+    int fd = open(fn, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+        return 1;
+    if (fstat(fd, &stat)) {
+        close(fd);
+        return 1;
+    }
+    if (stat.st_size > 0) {
+        addr = mmap(NULL, stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            close(fd);
+            return 1;
+        }
+        madvise(addr, stat.st_size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    auto h = solv_chksum_create(CHKSUM_TYPE);
+    solv_chksum_add(h, CHKSUM_IDENT, strlen(CHKSUM_IDENT));
+    if (addr) {
+        solv_chksum_add(h, addr, stat.st_size);
+        munmap(addr, stat.st_size);
+    }
+    solv_chksum_free(h, out);
+    return 0;
+}
+
+/* Opens fn for reading only if the checksum stored at its end equals cs.
+ * The trailing checksum is read with pread(), the returned stream is
+ * positioned at the start and has not buffered anything yet. */
+FILE *
+checksum_open_matching(const char *fn, const unsigned char *cs)
+{
+    struct stat stat;
+    unsigned char tail[CHKSUM_BYTES];
+    FILE *fp = NULL;
+    int fd = open(fn, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+        return NULL;
+    if (!fstat(fd, &stat) && stat.st_size >= CHKSUM_BYTES &&
+        pread(fd, tail, CHKSUM_BYTES, stat.st_size - CHKSUM_BYTES) == CHKSUM_BYTES &&
+        !checksum_cmp(tail, cs))
+        fp = fdopen(fd, "r");
+    if (fp == NULL)
+        close(fd);
+    return fp;
+}
+
 /* calls rewind(fp) before returning */
 int
 checksum_read(unsigned char *csout, FILE *fp)
@@ -31,6 +31,7 @@
 
 
 #include <stdlib.h>
+#include <vector>
 #include <solv/evr.h>
 #include <solv/pool.h>
 #include <solv/repo.h>
@@ -43,6 +44,7 @@
 #include "hy-package-private.hpp"
 #include "hy-repo-private.hpp"
 #include "repo/solvable/DependencyContainer.hpp"
+#include "sack/packagehandle.hpp"
 
 #define BLOCK_SIZE 31
 
@@ -255,23 +257,9 @@ dnf_package_installed(DnfPackage *pkg)
 int
 dnf_package_cmp(DnfPackage *pkg1, DnfPackage *pkg2)
 {
-    Pool *pool1 = dnf_package_get_pool(pkg1);
-    Pool *pool2 = dnf_package_get_pool(pkg2);
-    Solvable *s1 = pool_id2solvable(pool1, dnf_package_get_id(pkg1));
-    Solvable *s2 = pool_id2solvable(pool2, dnf_package_get_id(pkg2));
-    const char *str1 = pool_id2str(pool1, s1->name);
-    const char *str2 = pool_id2str(pool2, s2->name);
-    int ret = strcmp(str1, str2);
-    if (ret)
-        return ret;
-
-    ret = dnf_package_evr_cmp(pkg1, pkg2);
-    if (ret)
-        return ret;
-
-    str1 = pool_id2str(pool1, s1->arch);
-    str2 = pool_id2str(pool2, s2->arch);
-    return strcmp(str1, str2);
+    libdnf::PackageHandle handle1(dnf_package_get_sack(pkg1), dnf_package_get_id(pkg1));
+    libdnf::PackageHandle handle2(dnf_package_get_sack(pkg2), dnf_package_get_id(pkg2));
+    return handle1.cmp(handle2);
 }
 
 /**
@@ -956,36 +944,14 @@ dnf_package_get_files(DnfPackage *pkg)
 GPtrArray *
 dnf_package_get_advisories(DnfPackage *pkg, int cmp_type)
 {
-    Dataiterator di;
-    Id evr;
-    int cmp;
-    DnfAdvisory *advisory;
-    Pool *pool = dnf_package_get_pool(pkg);
     DnfSack *sack = dnf_package_get_sack(pkg);
     GPtrArray *advisorylist = g_ptr_array_new();
-    Solvable *s = get_solvable(pkg);
-
-    dataiterator_init(&di, pool, 0, 0, UPDATE_COLLECTION_NAME,
-                      pool_id2str(pool, s->name), SEARCH_STRING);
-    dataiterator_prepend_keyname(&di, UPDATE_COLLECTION);
-    while (dataiterator_step(&di)) {
-        dataiterator_setpos_parent(&di);
-        if (pool_lookup_id(pool, SOLVID_POS, UPDATE_COLLECTION_ARCH) != s->arch)
-            continue;
-        evr = pool_lookup_id(pool, SOLVID_POS, UPDATE_COLLECTION_EVR);
-        if (!evr)
-            continue;
+    std::vector<Id> advisories;
 
-        cmp = pool_evrcmp(pool, evr, s->evr, EVRCMP_COMPARE);
-        if ((cmp > 0 && (cmp_type & HY_GT)) ||
-            (cmp < 0 && (cmp_type & HY_LT)) ||
-            (cmp == 0 && (cmp_type & HY_EQ))) {
-            advisory = dnf_advisory_new(sack, di.solvid);
-            g_ptr_array_add(advisorylist, advisory);
-            dataiterator_skip_solvable(&di);
-        }
-    }
-    dataiterator_free(&di);
+    dnf_sack_get_advisory_index(sack).getAdvisories(dnf_package_get_pool(pkg),
+                                                    dnf_package_get_id(pkg), cmp_type, advisories);
+    for (auto advisory : advisories)
+        g_ptr_array_add(advisorylist, dnf_advisory_new(sack, advisory));
     return advisorylist;
 }
 
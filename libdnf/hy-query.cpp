@@ -216,6 +216,15 @@ hy_query_run_set(HyQuery q)
     return new libdnf::PackageSet(*q->runSet());
 }
 
+DnfPackage *
+hy_query_next_package(HyQuery q, Id *cursor)
+{
+    *cursor = q->runSet()->next(*cursor);
+    if (*cursor == -1)
+        return NULL;
+    return dnf_package_new(q->getSack(), *cursor);
+}
+
 /**
  * hy_query_union:
  * @q:     a #HyQuery instance
@@ -94,6 +94,12 @@ void hy_query_filter_latest(HyQuery q, int val);
 
 GPtrArray *hy_query_run(HyQuery q);
 DnfPackageSet *hy_query_run_set(HyQuery q);
+/**
+ * Returns the next package of the query result after the cursor and moves the cursor to it,
+ * or NULL when there is none. Initialize the cursor to -1. Packages are created on demand,
+ * the query must not change while it is iterated.
+ */
+DnfPackage *hy_query_next_package(HyQuery q, Id *cursor);
 
 void hy_query_union(HyQuery q, HyQuery other);
 void hy_query_intersection(HyQuery q, HyQuery other);
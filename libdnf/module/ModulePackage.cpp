@@ -21,10 +21,6 @@
 #include <iostream>
 #include <sstream>
 #include <utility>
-extern "C" {
-#include <solv/solver.h>
-#include <solv/transaction.h>
-}
 
 #include "ModulePackage.hpp"
 #include "libdnf/utils/File.hpp"
@@ -270,6 +266,16 @@ bool ModulePackage::isEnabled()
     return state == ModuleState::ENABLED;
 }
 
+/**
+ * @brief Is a ModulePackage part of a disabled stream?
+ *
+ * @return bool
+ */
+bool ModulePackage::isDisabled()
+{
+    return state == ModuleState::DISABLED;
+}
+
 /**
  * @brief Mark ModulePackage as part of an enabled stream.
  */
@@ -278,17 +284,33 @@ void ModulePackage::enable()
     state = ModuleState::ENABLED;
 }
 
+/**
+ * @brief Mark ModulePackage as part of a disabled stream, it is not active even if the stream
+ * is the default one.
+ */
+void ModulePackage::disable()
+{
+    state = ModuleState::DISABLED;
+}
+
 /**
  * @brief Add conflict with a module stream represented as a ModulePackage.
  */
 void ModulePackage::addStreamConflict(const std::shared_ptr<ModulePackage> &package)
 {
     std::ostringstream ss;
-    Solvable *solvable = pool_id2solvable(pool, id);
 
     ss << "module(" + package->getNameStream() + ")";
-    auto depId = pool_str2id(pool, ss.str().c_str(), 1);
-    solvable_add_deparray(solvable, SOLVABLE_CONFLICTS, depId, -1);
+    addStreamConflict(pool_str2id(pool, ss.str().c_str(), 1));
+}
+
+/**
+ * @brief Add conflict with a module stream given by its module($name:$stream) dependency.
+ */
+void ModulePackage::addStreamConflict(Id streamDependency)
+{
+    Solvable *solvable = pool_id2solvable(pool, id);
+    solvable_add_deparray(solvable, SOLVABLE_CONFLICTS, streamDependency, -1);
 }
 
 static std::pair<std::string, std::string> getPlatformStream(const std::string &osReleasePath)
@@ -366,30 +388,3 @@ Id createPlatformSolvable(Pool *pool, const std::string &osReleasePath,
 
     return id;
 }
-
-std::unique_ptr<libdnf::IdQueue> moduleSolve(const std::vector<std::shared_ptr<ModulePackage>> & modules)
-{
-    if (modules.empty()) {
-        return {};
-    }
-    Pool * pool = modules[0]->getPool();
-    pool_createwhatprovides(pool);
-    std::vector<Id> solvedIds;
-    libdnf::IdQueue job;
-    for (const auto &module : modules) {
-        std::ostringstream ss;
-        ss << "module(" << module->getName() << ":" << module->getStream() << ":" << module->getVersion() << ")";
-        Id dep = pool_str2id(pool, ss.str().c_str(), 1);
-        job.pushBack(SOLVER_SOLVABLE_PROVIDES | SOLVER_INSTALL | SOLVER_WEAK, dep);
-    }
-    auto solver = solver_create(pool);
-    solver_solve(solver, job.getQueue());
-    auto transaction = solver_create_transaction(solver);
-    // TODO Use Goal to allow debuging
-
-    std::unique_ptr<libdnf::IdQueue> installed(new libdnf::IdQueue);
-    transaction_installedresult(transaction, installed->getQueue());
-    transaction_free(transaction);
-    solver_free(solver);
-    return installed;
-}
@@ -38,7 +38,8 @@ class ModulePackage // TODO inherit in future; : public Package
 public:
     enum class ModuleState {
         UNKNOWN,
-        ENABLED
+        ENABLED,
+        DISABLED
     };
 
     ModulePackage(Pool *pool, Repo *repo, const std::shared_ptr<ModuleMetadata> &metadata);
@@ -66,10 +67,13 @@ public:
     std::vector<std::shared_ptr<ModuleDependencies> > getModuleDependencies() const;
 
     bool isEnabled();
+    bool isDisabled();
 
     void addStreamConflict(const std::shared_ptr<ModulePackage> &package);
+    void addStreamConflict(Id streamDependency);
 
     void enable();
+    void disable();
 
     Id getId() const { return id; };
     Pool * getPool();
@@ -89,6 +93,5 @@ inline Pool * ModulePackage::getPool() { return pool;}
 
 Id createPlatformSolvable(Pool *pool, const std::string &osReleasePath,
     const std::string install_root, const char *  platformModule);
-std::unique_ptr<libdnf::IdQueue> moduleSolve(const std::vector<std::shared_ptr<ModulePackage>> & modules);
 
 #endif //LIBDNF_MODULEPACKAGE_HPP
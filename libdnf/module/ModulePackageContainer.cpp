@@ -19,14 +19,18 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <set>
+#include <sstream>
 extern "C" {
 #include <solv/poolarch.h>
+#include <solv/transaction.h>
 }
 
 #include "ModulePackageContainer.hpp"
 #include "ModulePackageMaker.hpp"
 
+#include "libdnf/log.hpp"
 #include "libdnf/utils/utils.hpp"
 #include "libdnf/utils/File.hpp"
 
@@ -40,7 +44,10 @@ ModulePackageContainer::ModulePackageContainer(const std::shared_ptr<Pool> &pool
 
 void ModulePackageContainer::add(const std::shared_ptr<ModulePackage> &package)
 {
-    modules.insert(std::make_pair(package->getId(), package));
+    if (modules.insert(std::make_pair(package->getId(), package)).second) {
+        nameStreams[package->getName()][package->getStream()].push_back(package->getId());
+        ++dependencyGeneration;
+    }
 }
 
 void ModulePackageContainer::add(const std::vector<std::shared_ptr<ModulePackage>> &packages)
@@ -52,7 +59,9 @@ void ModulePackageContainer::add(const std::vector<std::shared_ptr<ModulePackage
 
 void ModulePackageContainer::add(const std::map<Id, std::shared_ptr<ModulePackage>> &packages)
 {
-    modules.insert(std::begin(packages), std::end(packages));
+    for (const auto &iter : packages) {
+        add(iter.second);
+    }
 }
 
 std::shared_ptr<ModulePackage> ModulePackageContainer::getModulePackage(Id id)
@@ -62,12 +71,66 @@ std::shared_ptr<ModulePackage> ModulePackageContainer::getModulePackage(Id id)
 
 void ModulePackageContainer::enable(const std::string &name, const std::string &stream)
 {
-    for (const auto &iter : modules) {
-        auto modulePackage = iter.second;
-        if (modulePackage->getName() == name && modulePackage->getStream() == stream) {
-            modulePackage->enable();
+    setStreamState(name, stream, true);
+}
+
+/**
+ * @brief Disable all modules of the stream, they are not active even if it is the default stream.
+ * Changes are applied by the next call of getActiveModulePackages().
+ */
+void ModulePackageContainer::disable(const std::string &name, const std::string &stream)
+{
+    setStreamState(name, stream, false);
+}
+
+void ModulePackageContainer::setStreamState(const std::string &name, const std::string &stream, bool enable)
+{
+    auto nameIter = nameStreams.find(name);
+    if (nameIter == nameStreams.end())
+        return;
+    auto streamIter = nameIter->second.find(stream);
+    if (streamIter == nameIter->second.end())
+        return;
+
+    for (Id id : streamIter->second) {
+        if (enable)
+            modules[id]->enable();
+        else
+            modules[id]->disable();
+    }
+}
+
+/**
+ * @brief Make every module conflict with all other streams of the same module name, so that
+ * only one stream of a module can be active. The dependency of each stream is created once.
+ */
+void ModulePackageContainer::createConflictsBetweenStreams()
+{
+    for (const auto &nameIter : nameStreams) {
+        const auto &streams = nameIter.second;
+        if (streams.size() < 2)
+            continue;
+
+        std::vector<Id> streamDependencies;
+        streamDependencies.reserve(streams.size());
+        for (const auto &streamIter : streams) {
+            std::string dependency = "module(" + nameIter.first + ":" + streamIter.first + ")";
+            streamDependencies.push_back(pool_str2id(pool.get(), dependency.c_str(), 1));
+        }
+
+        size_t streamIndex = 0;
+        for (const auto &streamIter : streams) {
+            for (Id id : streamIter.second) {
+                const auto &modulePackage = modules[id];
+                for (size_t i = 0; i < streamDependencies.size(); ++i) {
+                    if (i != streamIndex)
+                        modulePackage->addStreamConflict(streamDependencies[i]);
+                }
+            }
+            ++streamIndex;
         }
     }
+    ++dependencyGeneration;
 }
 
 std::vector<std::shared_ptr<ModulePackage>> ModulePackageContainer::getActiveModulePackages(const std::map<std::string, std::string> &defaultStreams)
@@ -85,7 +148,7 @@ std::vector<std::shared_ptr<ModulePackage>> ModulePackageContainer::getActiveMod
             // TODO logger.debug(exception.what())
         }
 
-        if (module->isEnabled() || hasDefaultStream) {
+        if (module->isEnabled() || (hasDefaultStream && !module->isDisabled())) {
             packages.push_back(module);
         }
     }
@@ -94,19 +157,102 @@ std::vector<std::shared_ptr<ModulePackage>> ModulePackageContainer::getActiveMod
 
 std::vector<std::shared_ptr<ModulePackage>> ModulePackageContainer::getActiveModulePackages(const std::vector<std::shared_ptr<ModulePackage>> &modulePackages)
 {
-    std::vector<std::shared_ptr<ModulePackage>> packages;
-    auto ids = moduleSolve(modulePackages);
-
-    packages.reserve(ids->size());
-    for (int i = 0; i < ids->size(); ++i) {
-        Id id = (*ids)[i];
-        auto solvable = pool_id2solvable(pool.get(), id);
-        // TODO use Goal::listInstalls() to not requires filtering out Platform
-        if (strcmp(solvable->repo->name, HY_SYSTEM_REPO_NAME) == 0)
-            continue;
-        packages.push_back(modules[id]);
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<Id> requested;
+    requested.reserve(modulePackages.size());
+    for (const auto &modulePackage : modulePackages) {
+        requested.push_back(modulePackage->getId());
+    }
+    std::sort(requested.begin(), requested.end());
+
+    bool reused = solver && solverNsolvables == pool->nsolvables &&
+        solverGeneration == dependencyGeneration && requested == lastRequested;
+    if (reused) {
+        lastActivityChange = ActivityChange();
+    } else {
+        libdnf::IdQueue ids;
+        if (!requested.empty())
+            solve(requested, ids);
+
+        std::vector<std::shared_ptr<ModulePackage>> packages;
+        packages.reserve(ids.size());
+        for (int i = 0; i < ids.size(); ++i) {
+            Id id = ids[i];
+            auto solvable = pool_id2solvable(pool.get(), id);
+            // TODO use Goal::listInstalls() to not requires filtering out Platform
+            if (strcmp(solvable->repo->name, HY_SYSTEM_REPO_NAME) == 0)
+                continue;
+            packages.push_back(modules[id]);
+        }
+        updateActivity(packages);
+        activeModulePackages = std::move(packages);
+        lastRequested = std::move(requested);
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::ostringstream ss;
+    ss << "Module resolution" << (reused ? " (unchanged request)" : "") << ": "
+       << modulePackages.size() << " requested, " << activeModulePackages.size() << " active, "
+       << lastActivityChange.activated.size() << " activated, "
+       << lastActivityChange.deactivated.size() << " deactivated in " << elapsed.count() << " ms";
+    libdnf::Log::getLogger()->debug(ss.str());
+
+    return activeModulePackages;
+}
+
+/**
+ * @brief Solve the request with the solver kept from the previous call. Whatprovides of the
+ * pool and the solver are recreated only if solvables or dependencies were added since.
+ */
+void ModulePackageContainer::solve(const std::vector<Id> &requested, libdnf::IdQueue &installed)
+{
+    Pool *solvPool = pool.get();
+    if (!solver || solverNsolvables != solvPool->nsolvables ||
+        solverGeneration != dependencyGeneration) {
+        pool_createwhatprovides(solvPool);
+        solver.reset(solver_create(solvPool));
+        solverNsolvables = solvPool->nsolvables;
+        solverGeneration = dependencyGeneration;
+    }
+
+    libdnf::IdQueue job;
+    for (Id id : requested) {
+        auto dependency = jobDependencies.find(id);
+        if (dependency == jobDependencies.end()) {
+            std::string module = "module(" + modules[id]->getNameStreamVersion() + ")";
+            dependency = jobDependencies.emplace(id, pool_str2id(solvPool, module.c_str(), 1)).first;
+        }
+        job.pushBack(SOLVER_SOLVABLE_PROVIDES | SOLVER_INSTALL | SOLVER_WEAK, dependency->second);
+    }
+
+    solver_solve(solver.get(), job.getQueue());
+    auto transaction = solver_create_transaction(solver.get());
+    // TODO Use Goal to allow debuging
+    transaction_installedresult(transaction, installed.getQueue());
+    transaction_free(transaction);
+}
+
+void ModulePackageContainer::updateActivity(const std::vector<std::shared_ptr<ModulePackage>> &packages)
+{
+    std::set<Id> previous;
+    for (const auto &modulePackage : activeModulePackages) {
+        previous.insert(modulePackage->getId());
+    }
+    std::set<Id> current;
+    for (const auto &modulePackage : packages) {
+        current.insert(modulePackage->getId());
+    }
+
+    lastActivityChange = ActivityChange();
+    for (Id id : current) {
+        if (!previous.count(id))
+            lastActivityChange.activated.push_back(modules[id]);
+    }
+    for (Id id : previous) {
+        if (!current.count(id))
+            lastActivityChange.deactivated.push_back(modules[id]);
     }
-    return packages;
 }
 
 std::vector<std::shared_ptr<ModulePackage>> ModulePackageContainer::getModulePackages()
@@ -24,9 +24,14 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <set>
 
+extern "C" {
+#include <solv/solver.h>
+}
+
 #include "ModulePackage.hpp"
 
 class ModulePackageContainer
@@ -52,6 +57,15 @@ public:
         explicit EnabledStreamException(const std::string &moduleName) : Exception("No enabled stream for module: " + moduleName) {}
     };
 
+    /**
+    * @brief Modules which became active or inactive by the last call of getActiveModulePackages()
+    */
+    struct ActivityChange
+    {
+        std::vector<std::shared_ptr<ModulePackage>> activated;
+        std::vector<std::shared_ptr<ModulePackage>> deactivated;
+    };
+
     explicit ModulePackageContainer(const std::shared_ptr<Pool> &pool, const char * arch);
     ~ModulePackageContainer() = default;
 
@@ -62,17 +76,41 @@ public:
     std::vector<std::shared_ptr<ModulePackage>> getModulePackages();
 
     void enable(const std::string &name, const std::string &stream);
+    void disable(const std::string &name, const std::string &stream);
+
+    void createConflictsBetweenStreams();
 
     std::vector<std::shared_ptr<ModulePackage>> getActiveModulePackages(const std::map<std::string, std::string> &defaultStreams);
+    const ActivityChange & getLastActivityChange() const { return lastActivityChange; }
 
 
     std::shared_ptr<Pool> getPool() { return pool; };
 
 private:
     std::vector<std::shared_ptr<ModulePackage>> getActiveModulePackages(const std::vector<std::shared_ptr<ModulePackage>> &modulePackages);
+    void setStreamState(const std::string &name, const std::string &stream, bool enable);
+    void solve(const std::vector<Id> &requested, libdnf::IdQueue &installed);
+    void updateActivity(const std::vector<std::shared_ptr<ModulePackage>> &packages);
 
     std::map<Id, std::shared_ptr<ModulePackage>> modules;
+    /// module name -> stream -> ids of the modules of the stream
+    std::map<std::string, std::map<std::string, std::vector<Id>>> nameStreams;
     std::shared_ptr<Pool> pool;
+
+    // Resolution state kept between calls of getActiveModulePackages(). The solver and the
+    // whatprovides of the pool are recreated only when solvables were added to the pool or
+    // dependencies of modules changed, and an unchanged request returns the previous result
+    // without solving.
+    std::unique_ptr<Solver, void (*)(Solver *)> solver{nullptr, &solver_free};
+    int solverNsolvables{0};
+    /// bumped by add() and createConflictsBetweenStreams()
+    unsigned int dependencyGeneration{0};
+    unsigned int solverGeneration{0};
+    /// module id -> its module($name:$stream:$version) dependency used in the solver job
+    std::unordered_map<Id, Id> jobDependencies;
+    std::vector<Id> lastRequested;
+    std::vector<std::shared_ptr<ModulePackage>> activeModulePackages;
+    ActivityChange lastActivityChange;
 };
 
 
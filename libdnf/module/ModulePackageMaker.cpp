@@ -29,6 +29,12 @@ std::map<Id, std::shared_ptr<ModulePackage>> ModulePackageMaker::fromString(Pool
     return createModulePackages(pool, repo, metadata);
 }
 
+std::map<Id, std::shared_ptr<ModulePackage>> ModulePackageMaker::fromObjects(Pool *pool, HyRepo repo, GPtrArray *data)
+{
+    auto metadata = ModuleMetadata::wrapModulemdModule(data);
+    return createModulePackages(pool, repo, metadata);
+}
+
 std::map<Id, std::shared_ptr<ModulePackage>> ModulePackageMaker::createModulePackages(Pool *pool, HyRepo repo, const std::vector<std::shared_ptr<ModuleMetadata>> &metadata)
 {
     std::map<Id, std::shared_ptr<ModulePackage>> modules;
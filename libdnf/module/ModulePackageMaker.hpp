@@ -30,6 +30,7 @@ class ModulePackageMaker
 {
 public:
     static std::map<Id, std::shared_ptr<ModulePackage>> fromString(Pool *pool, HyRepo repo, const std::string &fileContent);
+    static std::map<Id, std::shared_ptr<ModulePackage>> fromObjects(Pool *pool, HyRepo repo, GPtrArray *data);
 
 private:
     static std::map<Id, std::shared_ptr<ModulePackage>> createModulePackages(Pool *pool, HyRepo repo, const std::vector<std::shared_ptr<ModuleMetadata>> &metadata);
@@ -37,6 +37,11 @@ void ModuleDefaultsContainer::fromString(const std::string &content, int priorit
     reportFailures(failures);
 }
 
+void ModuleDefaultsContainer::fromObjects(GPtrArray *data, int priority)
+{
+    saveDefaults(data, priority);
+}
+
 std::string ModuleDefaultsContainer::getDefaultStreamFor(std::string moduleName)
 {
     auto moduleDefaults = defaults[moduleName];
@@ -50,6 +50,7 @@ public:
     ~ModuleDefaultsContainer() = default;
 
     void fromString(const std::string &content, int priority);
+    void fromObjects(GPtrArray *data, int priority);
 
     std::string getDefaultStreamFor(std::string moduleName);
     std::map<std::string, std::string> getDefaultStreams();
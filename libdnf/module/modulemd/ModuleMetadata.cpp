@@ -26,13 +26,24 @@
 #include "profile/ModuleProfile.hpp"
 
 std::vector<std::shared_ptr<ModuleMetadata> > ModuleMetadata::metadataFromString(const std::string &fileContent)
+{
+    g_autoptr(GPtrArray) data = objectsFromString(fileContent);
+    return wrapModulemdModule(data);
+}
+
+/**
+ * @brief Parse all documents of a modules yaml, both modules and module defaults.
+ *
+ * @return GPtrArray* of modulemd objects owned by the caller, may be nullptr
+ */
+GPtrArray * ModuleMetadata::objectsFromString(const std::string &fileContent)
 {
     GError *error = nullptr;
     g_autoptr(GPtrArray) failures;
-    g_autoptr(GPtrArray) data = modulemd_objects_from_string_ext(fileContent.c_str(), &failures, &error);
+    GPtrArray *data = modulemd_objects_from_string_ext(fileContent.c_str(), &failures, &error);
 
     reportFailures(failures);
-    return wrapModulemdModule(data);
+    return data;
 }
 
 std::vector<std::shared_ptr<ModuleMetadata> > ModuleMetadata::wrapModulemdModule(GPtrArray *data)
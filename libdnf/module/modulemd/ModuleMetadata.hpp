@@ -34,6 +34,8 @@ class ModuleMetadata
 {
 public:
     static std::vector<std::shared_ptr<ModuleMetadata> > metadataFromString(const std::string &fileContent);
+    static GPtrArray * objectsFromString(const std::string &fileContent);
+    static std::vector<std::shared_ptr<ModuleMetadata> > wrapModulemdModule(GPtrArray *data);
 
 public:
     explicit ModuleMetadata(const std::shared_ptr<ModulemdModule> &modulemd);
@@ -52,8 +54,6 @@ public:
     std::shared_ptr<Profile> getProfile(const std::string &profileName) const;
 
 private:
-    static std::vector<std::shared_ptr<ModuleMetadata> > wrapModulemdModule(GPtrArray *data);
-
     std::shared_ptr<ModulemdModule> modulemd;
     static void reportFailures(const GPtrArray *failures);
 };
@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <sys/stat.h>
+
+#include "ModuleMetadataCache.hpp"
+
+namespace {
+
+const char MAGIC[8] = {'M', 'D', 'C', 'A', 'C', 'H', 'E', '\0'};
+constexpr uint32_t FORMAT_VERSION = 1;
+constexpr uint32_t NULL_LENGTH = UINT32_MAX;
+
+enum RecordKind : uint32_t {
+    RECORD_END = 0,
+    RECORD_MODULE = 1,
+    RECORD_DEFAULTS = 2
+};
+
+void writeUInt32(FILE *fp, uint32_t value)
+{
+    fwrite(&value, sizeof(value), 1, fp);
+}
+
+void writeUInt64(FILE *fp, uint64_t value)
+{
+    fwrite(&value, sizeof(value), 1, fp);
+}
+
+void writeString(FILE *fp, const char *value)
+{
+    if (value == nullptr) {
+        writeUInt32(fp, NULL_LENGTH);
+        return;
+    }
+    auto length = static_cast<uint32_t>(strlen(value));
+    writeUInt32(fp, length);
+    fwrite(value, 1, length, fp);
+}
+
+void writeSimpleSet(FILE *fp, ModulemdSimpleSet *set)
+{
+    if (set == nullptr) {
+        writeUInt32(fp, 0);
+        return;
+    }
+    gchar **values = modulemd_simpleset_dup(set);
+    writeUInt32(fp, g_strv_length(values));
+    for (auto item = values; *item; ++item)
+        writeString(fp, *item);
+    g_strfreev(values);
+}
+
+void writeModule(FILE *fp, ModulemdModule *module)
+{
+    writeUInt64(fp, modulemd_module_peek_mdversion(module));
+    writeString(fp, modulemd_module_peek_name(module));
+    writeString(fp, modulemd_module_peek_stream(module));
+    writeUInt64(fp, modulemd_module_peek_version(module));
+    writeString(fp, modulemd_module_peek_context(module));
+    writeString(fp, modulemd_module_peek_arch(module));
+    writeSimpleSet(fp, modulemd_module_peek_rpm_artifacts(module));
+
+    GPtrArray *dependencies = modulemd_module_peek_dependencies(module);
+    writeUInt32(fp, dependencies ? dependencies->len : 0);
+    for (unsigned int i = 0; dependencies && i < dependencies->len; i++) {
+        auto dependency = static_cast<ModulemdDependencies *>(g_ptr_array_index(dependencies, i));
+        GHashTable *requires = modulemd_dependencies_peek_requires(dependency);
+        writeUInt32(fp, requires ? g_hash_table_size(requires) : 0);
+        if (requires == nullptr)
+            continue;
+
+        GHashTableIter iterator;
+        gpointer key, value;
+        g_hash_table_iter_init(&iterator, requires);
+        while (g_hash_table_iter_next(&iterator, &key, &value)) {
+            writeString(fp, static_cast<const char *>(key));
+            writeSimpleSet(fp, static_cast<ModulemdSimpleSet *>(value));
+        }
+    }
+}
+
+void writeDefaults(FILE *fp, ModulemdDefaults *defaults)
+{
+    writeUInt64(fp, modulemd_defaults_peek_version(defaults));
+    writeString(fp, modulemd_defaults_peek_module_name(defaults));
+    writeString(fp, modulemd_defaults_peek_default_stream(defaults));
+
+    GHashTable *profiles = modulemd_defaults_peek_profile_defaults(defaults);
+    writeUInt32(fp, profiles ? g_hash_table_size(profiles) : 0);
+    if (profiles == nullptr)
+        return;
+
+    GHashTableIter iterator;
+    gpointer key, value;
+    g_hash_table_iter_init(&iterator, profiles);
+    while (g_hash_table_iter_next(&iterator, &key, &value)) {
+        writeString(fp, static_cast<const char *>(key));
+        writeSimpleSet(fp, static_cast<ModulemdSimpleSet *>(value));
+    }
+}
+
+struct String
+{
+    std::string value;
+    bool isNull{true};
+
+    const char * get() const { return isNull ? nullptr : value.c_str(); }
+};
+
+/**
+* @brief Reads the cache format, sizes are checked against the remaining file size so that
+* a damaged file never leads to huge allocations.
+*/
+class Reader
+{
+public:
+    explicit Reader(FILE *fp) : fp(fp)
+    {
+        struct stat st;
+        long position = ftell(fp);
+        if (position < 0 || fstat(fileno(fp), &st) || st.st_size < position)
+            ok = false;
+        else
+            remaining = static_cast<uint64_t>(st.st_size - position);
+    }
+
+    bool isOk() const { return ok; }
+
+    bool readBytes(void *out, uint64_t size)
+    {
+        if (!ok || size > remaining || (size && fread(out, size, 1, fp) != 1))
+            ok = false;
+        else
+            remaining -= size;
+        return ok;
+    }
+
+    uint32_t readUInt32()
+    {
+        uint32_t value = 0;
+        readBytes(&value, sizeof(value));
+        return value;
+    }
+
+    uint64_t readUInt64()
+    {
+        uint64_t value = 0;
+        readBytes(&value, sizeof(value));
+        return value;
+    }
+
+    /// Reads a count of items, each of them takes at least four bytes
+    uint32_t readCount()
+    {
+        uint32_t count = readUInt32();
+        if (count > remaining / sizeof(uint32_t))
+            ok = false;
+        return ok ? count : 0;
+    }
+
+    String readString()
+    {
+        String result;
+        uint32_t length = readUInt32();
+        if (!ok || length == NULL_LENGTH)
+            return result;
+        if (length > remaining) {
+            ok = false;
+            return result;
+        }
+        result.value.resize(length);
+        result.isNull = !readBytes(&result.value[0], length);
+        return result;
+    }
+
+private:
+    FILE *fp;
+    uint64_t remaining{0};
+    bool ok{true};
+};
+
+ModulemdSimpleSet * readSimpleSet(Reader &in)
+{
+    ModulemdSimpleSet *set = modulemd_simpleset_new();
+    uint32_t count = in.readCount();
+    for (uint32_t i = 0; i < count && in.isOk(); i++) {
+        auto value = in.readString();
+        if (!value.isNull)
+            modulemd_simpleset_add(set, value.get());
+    }
+    return set;
+}
+
+ModulemdModule * readModule(Reader &in)
+{
+    ModulemdModule *module = modulemd_module_new();
+    modulemd_module_set_mdversion(module, in.readUInt64());
+    modulemd_module_set_name(module, in.readString().get());
+    modulemd_module_set_stream(module, in.readString().get());
+    modulemd_module_set_version(module, in.readUInt64());
+    modulemd_module_set_context(module, in.readString().get());
+    modulemd_module_set_arch(module, in.readString().get());
+
+    ModulemdSimpleSet *artifacts = readSimpleSet(in);
+    modulemd_module_set_rpm_artifacts(module, artifacts);
+    g_object_unref(artifacts);
+
+    uint32_t dependencyCount = in.readCount();
+    for (uint32_t i = 0; i < dependencyCount && in.isOk(); i++) {
+        ModulemdDependencies *dependency = modulemd_dependencies_new();
+        uint32_t requiresCount = in.readCount();
+        for (uint32_t j = 0; j < requiresCount && in.isOk(); j++) {
+            auto moduleName = in.readString();
+            ModulemdSimpleSet *streams = readSimpleSet(in);
+            gchar **streamValues = modulemd_simpleset_dup(streams);
+            if (!moduleName.isNull)
+                modulemd_dependencies_add_requires(dependency, moduleName.get(),
+                                                   const_cast<const gchar **>(streamValues));
+            g_strfreev(streamValues);
+            g_object_unref(streams);
+        }
+        modulemd_module_add_dependencies(module, dependency);
+        g_object_unref(dependency);
+    }
+    return module;
+}
+
+ModulemdDefaults * readDefaults(Reader &in)
+{
+    ModulemdDefaults *defaults = modulemd_defaults_new();
+    modulemd_defaults_set_version(defaults, in.readUInt64());
+    modulemd_defaults_set_module_name(defaults, in.readString().get());
+    modulemd_defaults_set_default_stream(defaults, in.readString().get());
+
+    uint32_t profileCount = in.readCount();
+    for (uint32_t i = 0; i < profileCount && in.isOk(); i++) {
+        auto stream = in.readString();
+        ModulemdSimpleSet *profiles = readSimpleSet(in);
+        if (!stream.isNull)
+            modulemd_defaults_assign_profiles_for_stream(defaults, stream.get(), profiles);
+        g_object_unref(profiles);
+    }
+    return defaults;
+}
+
+}
+
+GPtrArray * ModuleMetadataCache::read(FILE *fp)
+{
+    Reader in(fp);
+    char magic[sizeof(MAGIC)];
+    if (!in.readBytes(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+        return nullptr;
+    if (in.readUInt32() != FORMAT_VERSION)
+        return nullptr;
+
+    // a truncated file has no end record and fails on reading past the end of the file
+    GPtrArray *data = g_ptr_array_new_with_free_func(g_object_unref);
+    for (auto kind = in.readUInt32(); in.isOk(); kind = in.readUInt32()) {
+        if (kind == RECORD_END)
+            return data;
+        else if (kind == RECORD_MODULE)
+            g_ptr_array_add(data, readModule(in));
+        else if (kind == RECORD_DEFAULTS)
+            g_ptr_array_add(data, readDefaults(in));
+        else
+            break;
+    }
+
+    g_ptr_array_unref(data);
+    return nullptr;
+}
+
+bool ModuleMetadataCache::write(GPtrArray *data, FILE *fp)
+{
+    fwrite(MAGIC, sizeof(MAGIC), 1, fp);
+    writeUInt32(fp, FORMAT_VERSION);
+
+    for (unsigned int i = 0; data && i < data->len; i++) {
+        auto item = g_ptr_array_index(data, i);
+        if (MODULEMD_IS_MODULE(item)) {
+            writeUInt32(fp, RECORD_MODULE);
+            writeModule(fp, static_cast<ModulemdModule *>(item));
+        } else if (MODULEMD_IS_DEFAULTS(item)) {
+            writeUInt32(fp, RECORD_DEFAULTS);
+            writeDefaults(fp, static_cast<ModulemdDefaults *>(item));
+        }
+    }
+    writeUInt32(fp, RECORD_END);
+
+    return ferror(fp) == 0;
+}
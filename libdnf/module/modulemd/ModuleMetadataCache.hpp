@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LIBDNF_MODULEMETADATACACHE_HPP
+#define LIBDNF_MODULEMETADATACACHE_HPP
+
+#include <cstdio>
+
+#include <modulemd/modulemd.h>
+
+/**
+* @brief Binary form of the module metadata of a repository. Only the data needed to filter
+* modular packages is kept: name, stream, version, context, arch, rpm artifacts and runtime
+* requires of modules, and default streams with their profiles of module defaults.
+*/
+class ModuleMetadataCache
+{
+public:
+    /**
+    * @brief Reads objects stored by write() from the current position of fp.
+    *
+    * @return GPtrArray* of ModulemdModule and ModulemdDefaults objects owned by the caller,
+    * nullptr if the data are not a valid cache
+    */
+    static GPtrArray * read(FILE *fp);
+
+    /**
+    * @brief Writes ModulemdModule and ModulemdDefaults objects of data to fp, other objects
+    * are skipped.
+    *
+    * @return true on success
+    */
+    static bool write(GPtrArray *data, FILE *fp);
+};
+
+
+#endif //LIBDNF_MODULEMETADATACACHE_HPP
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <algorithm>
+#include <string.h>
+
+#include <solv/evr.h>
+#include <solv/repo.h>
+
+#include "advisoryindex.hpp"
+#include "../hy-types.h"
+#include "../dnf-advisory-private.hpp"
+#include "../dnf-sack-private.hpp"
+
+namespace libdnf {
+
+static bool
+entryCmp(const AdvisoryIndex::Entry & first, const AdvisoryIndex::Entry & second)
+{
+    if (first.name != second.name)
+        return first.name < second.name;
+    if (first.arch != second.arch)
+        return first.arch < second.arch;
+    if (first.evr != second.evr)
+        return first.evr < second.evr;
+    return first.advisory < second.advisory;
+}
+
+static bool
+entryCmpNameArch(const AdvisoryIndex::Entry & first, const AdvisoryIndex::Entry & second)
+{
+    if (first.name != second.name)
+        return first.name < second.name;
+    return first.arch < second.arch;
+}
+
+static bool
+entryCmpNevra(const AdvisoryIndex::Entry & first, const AdvisoryIndex::Entry & second)
+{
+    if (first.name != second.name)
+        return first.name < second.name;
+    if (first.arch != second.arch)
+        return first.arch < second.arch;
+    return first.evr < second.evr;
+}
+
+static void
+addKey(std::unordered_map<std::string, std::vector<Id>> & map, const char *key, Id advisory)
+{
+    if (!key)
+        return;
+    auto & advisories = map[key];
+    // a reference can repeat within one advisory
+    if (advisories.empty() || advisories.back() != advisory)
+        advisories.push_back(advisory);
+}
+
+AdvisoryIndex::AdvisoryIndex(DnfSack *sack)
+{
+    Pool *pool = dnf_sack_get_pool(sack);
+    Dataiterator di;
+    Id lastAdvisory = 0;
+
+    dataiterator_init(&di, pool, 0, 0, UPDATE_COLLECTION, 0, 0);
+    while (dataiterator_step(&di)) {
+        dataiterator_setpos(&di);
+        Entry entry;
+        entry.name = pool_lookup_id(pool, SOLVID_POS, UPDATE_COLLECTION_NAME);
+        entry.evr = pool_lookup_id(pool, SOLVID_POS, UPDATE_COLLECTION_EVR);
+        entry.arch = pool_lookup_id(pool, SOLVID_POS, UPDATE_COLLECTION_ARCH);
+        entry.advisory = di.solvid;
+        entries.push_back(entry);
+        if (di.solvid != lastAdvisory) {
+            lastAdvisory = di.solvid;
+            addAdvisory(pool, di.solvid);
+        }
+    }
+    dataiterator_free(&di);
+    std::sort(entries.begin(), entries.end(), entryCmp);
+    entries.erase(std::unique(entries.begin(), entries.end(),
+        [](const Entry & first, const Entry & second) {
+            return !entryCmp(first, second) && !entryCmp(second, first);
+        }), entries.end());
+    // repos are not guaranteed to be in ascending order of solvable ids
+    for (auto map : {&byName, &byBug, &byCVE, &byType, &bySeverity})
+        for (auto & item : *map)
+            std::sort(item.second.begin(), item.second.end());
+}
+
+void
+AdvisoryIndex::addAdvisory(Pool *pool, Id advisory)
+{
+    const char *name = pool_lookup_str(pool, advisory, SOLVABLE_NAME);
+    size_t prefixLen = strlen(SOLVABLE_NAME_ADVISORY_PREFIX);
+    if (name && strncmp(name, SOLVABLE_NAME_ADVISORY_PREFIX, prefixLen) == 0)
+        addKey(byName, name + prefixLen, advisory);
+    addKey(byType, pool_lookup_str(pool, advisory, SOLVABLE_PATCHCATEGORY), advisory);
+    addKey(bySeverity, pool_lookup_str(pool, advisory, UPDATE_SEVERITY), advisory);
+
+    Dataiterator di;
+    dataiterator_init(&di, pool, 0, advisory, UPDATE_REFERENCE, 0, 0);
+    while (dataiterator_step(&di)) {
+        dataiterator_setpos(&di);
+        const char *type = pool_lookup_str(pool, SOLVID_POS, UPDATE_REFERENCE_TYPE);
+        const char *id = pool_lookup_str(pool, SOLVID_POS, UPDATE_REFERENCE_ID);
+        if (!type)
+            continue;
+        if (strcmp(type, "bugzilla") == 0)
+            addKey(byBug, id, advisory);
+        else if (strcmp(type, "cve") == 0)
+            addKey(byCVE, id, advisory);
+    }
+    dataiterator_free(&di);
+}
+
+AdvisoryIndex::Range
+AdvisoryIndex::find(Id name, Id arch) const
+{
+    Entry key{name, arch, 0, 0};
+    auto range = std::equal_range(entries.begin(), entries.end(), key, entryCmpNameArch);
+    return Range(entries.data() + (range.first - entries.begin()),
+                 entries.data() + (range.second - entries.begin()));
+}
+
+AdvisoryIndex::Range
+AdvisoryIndex::find(Id name, Id arch, Id evr) const
+{
+    Entry key{name, arch, evr, 0};
+    auto range = std::equal_range(entries.begin(), entries.end(), key, entryCmpNevra);
+    return Range(entries.data() + (range.first - entries.begin()),
+                 entries.data() + (range.second - entries.begin()));
+}
+
+void
+AdvisoryIndex::getAdvisories(Pool *pool, Id solvable, int cmpType,
+                             std::vector<Id> & advisories) const
+{
+    Solvable *s = pool_id2solvable(pool, solvable);
+    auto range = find(s->name, s->arch);
+    size_t first = advisories.size();
+    Id lastEvr = 0;
+    int cmp = 0;
+
+    for (auto entry = range.first; entry != range.second; ++entry) {
+        if (!entry->evr)
+            continue;
+        // entries of one evr are adjacent, compare each evr once
+        if (entry->evr != lastEvr) {
+            lastEvr = entry->evr;
+            cmp = pool_evrcmp(pool, entry->evr, s->evr, EVRCMP_COMPARE);
+        }
+        if ((cmp > 0 && (cmpType & HY_GT)) ||
+            (cmp < 0 && (cmpType & HY_LT)) ||
+            (cmp == 0 && (cmpType & HY_EQ)))
+            advisories.push_back(entry->advisory);
+    }
+    std::sort(advisories.begin() + first, advisories.end());
+    advisories.erase(std::unique(advisories.begin() + first, advisories.end()), advisories.end());
+}
+
+const std::vector<Id> &
+AdvisoryIndex::lookup(const InvertedMap & map, const char *key)
+{
+    static const std::vector<Id> empty;
+    auto it = map.find(key);
+    return it == map.end() ? empty : it->second;
+}
+
+const std::vector<Id> &
+AdvisoryIndex::findByName(const char *name) const
+{
+    return lookup(byName, name);
+}
+
+const std::vector<Id> &
+AdvisoryIndex::findByBug(const char *bug) const
+{
+    return lookup(byBug, bug);
+}
+
+const std::vector<Id> &
+AdvisoryIndex::findByCVE(const char *cve) const
+{
+    return lookup(byCVE, cve);
+}
+
+const std::vector<Id> &
+AdvisoryIndex::findByType(const char *type) const
+{
+    return lookup(byType, type);
+}
+
+const std::vector<Id> &
+AdvisoryIndex::findBySeverity(const char *severity) const
+{
+    return lookup(bySeverity, severity);
+}
+
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __ADVISORY_INDEX_HPP
+#define __ADVISORY_INDEX_HPP
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <solv/pooltypes.h>
+
+#include "../dnf-types.h"
+
+namespace libdnf {
+
+/**
+* @brief Packages and attributes of all advisories in the pool collected in one pass over
+* the updateinfo data. The sack builds it lazily, see dnf_sack_get_advisory_index().
+*/
+struct AdvisoryIndex {
+public:
+    /**
+    * @brief One package of an advisory collection
+    */
+    struct Entry {
+        Id name;
+        Id arch;
+        Id evr;
+        Id advisory;
+    };
+
+    typedef std::pair<const Entry *, const Entry *> Range;
+
+    explicit AdvisoryIndex(DnfSack *sack);
+
+    /**
+    * @brief Returns collection entries with the given name and arch sorted by evr Id and
+    * advisory. Evr Ids are not ordered by version, use pool_evrcmp() to compare them.
+    */
+    Range find(Id name, Id arch) const;
+
+    /**
+    * @brief Returns collection entries with the given name, arch and evr
+    */
+    Range find(Id name, Id arch, Id evr) const;
+
+    /**
+    * @brief Appends advisories listing a package with the same name and arch as the solvable
+    * whose evr is in relation cmpType (HY_EQ, HY_GT, HY_LT) to the evr of the solvable. Each
+    * advisory is appended once, in ascending order of Ids.
+    */
+    void getAdvisories(Pool *pool, Id solvable, int cmpType, std::vector<Id> & advisories) const;
+
+    /**
+    * @brief Advisories matching exactly the given value, sorted by advisory Id
+    */
+    const std::vector<Id> & findByName(const char *name) const;
+    const std::vector<Id> & findByBug(const char *bug) const;
+    const std::vector<Id> & findByCVE(const char *cve) const;
+    const std::vector<Id> & findByType(const char *type) const;
+    const std::vector<Id> & findBySeverity(const char *severity) const;
+
+    size_t size() const { return entries.size(); }
+
+private:
+    typedef std::unordered_map<std::string, std::vector<Id>> InvertedMap;
+
+    std::vector<Entry> entries;
+    InvertedMap byName;
+    InvertedMap byBug;
+    InvertedMap byCVE;
+    InvertedMap byType;
+    InvertedMap bySeverity;
+
+    void addAdvisory(Pool *pool, Id advisory);
+    static const std::vector<Id> & lookup(const InvertedMap & map, const char *key);
+};
+
+}
+
+#endif /* __ADVISORY_INDEX_HPP */
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "bitmap.hpp"
+
+// Runtime dispatch relies on ifunc support of GCC on x86_64, other builds use the generic code
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define BITMAP_KERNEL __attribute__((target_clones("avx2", "popcnt", "default")))
+#else
+#define BITMAP_KERNEL
+#endif
+
+namespace libdnf {
+
+namespace {
+
+constexpr size_t WORD_BYTES = sizeof(uint64_t);
+
+/* Loads 8 bytes of the map so that bit n of the word is bit n of the map chunk. */
+inline uint64_t
+loadWord(const unsigned char *p)
+{
+    uint64_t word;
+    memcpy(&word, p, WORD_BYTES);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+inline void
+storeWord(unsigned char *p, uint64_t word)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    memcpy(p, &word, WORD_BYTES);
+}
+
+BITMAP_KERNEL size_t
+countKernel(const unsigned char *p, size_t size)
+{
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + WORD_BYTES <= size; i += WORD_BYTES)
+        count += __builtin_popcountll(loadWord(p + i));
+    for (; i < size; ++i)
+        count += __builtin_popcount(p[i]);
+    return count;
+}
+
+BITMAP_KERNEL void
+andKernel(unsigned char *t, const unsigned char *s, size_t size)
+{
+    size_t i = 0;
+    for (; i + WORD_BYTES <= size; i += WORD_BYTES)
+        storeWord(t + i, loadWord(t + i) & loadWord(s + i));
+    for (; i < size; ++i)
+        t[i] &= s[i];
+}
+
+BITMAP_KERNEL void
+subtractKernel(unsigned char *t, const unsigned char *s, size_t size)
+{
+    size_t i = 0;
+    for (; i + WORD_BYTES <= size; i += WORD_BYTES)
+        storeWord(t + i, loadWord(t + i) & ~loadWord(s + i));
+    for (; i < size; ++i)
+        t[i] &= ~s[i];
+}
+
+BITMAP_KERNEL void
+orKernel(unsigned char *t, const unsigned char *s, size_t size)
+{
+    size_t i = 0;
+    for (; i + WORD_BYTES <= size; i += WORD_BYTES)
+        storeWord(t + i, loadWord(t + i) | loadWord(s + i));
+    for (; i < size; ++i)
+        t[i] |= s[i];
+}
+
+/* Returns the lowest set bit at or after bit start, or -1. */
+Id
+findFrom(const Map *m, size_t start)
+{
+    const unsigned char *p = m->map;
+    size_t size = m->size;
+    size_t i = start >> 3;
+    if (i >= size)
+        return -1;
+
+    // finish the byte the search starts in
+    unsigned char byte = p[i] >> (start & 7);
+    if (byte)
+        return static_cast<Id>(start + __builtin_ctz(byte));
+    ++i;
+
+    // bytes up to the word boundary, then whole words
+    for (; i < size && (i % WORD_BYTES); ++i)
+        if (p[i])
+            return static_cast<Id>((i << 3) + __builtin_ctz(p[i]));
+    for (; i + WORD_BYTES <= size; i += WORD_BYTES) {
+        uint64_t word = loadWord(p + i);
+        if (word)
+            return static_cast<Id>((i << 3) + __builtin_ctzll(word));
+    }
+    for (; i < size; ++i)
+        if (p[i])
+            return static_cast<Id>((i << 3) + __builtin_ctz(p[i]));
+    return -1;
+}
+
+}
+
+size_t
+bitmapCount(const Map *m)
+{
+    return countKernel(m->map, m->size);
+}
+
+bool
+bitmapEmpty(const Map *m)
+{
+    return findFrom(m, 0) == -1;
+}
+
+Id
+bitmapNext(const Map *m, Id previous)
+{
+    return findFrom(m, previous < 0 ? 0 : static_cast<size_t>(previous) + 1);
+}
+
+Id
+bitmapNth(const Map *m, size_t index)
+{
+    const unsigned char *p = m->map;
+    size_t size = m->size;
+    size_t i = 0;
+
+    // skip whole words by their popcount, then find the bit within the word
+    for (; i + WORD_BYTES <= size; i += WORD_BYTES) {
+        uint64_t word = loadWord(p + i);
+        size_t count = __builtin_popcountll(word);
+        if (index >= count) {
+            index -= count;
+            continue;
+        }
+        for (; index; --index)
+            word &= word - 1;
+        return static_cast<Id>((i << 3) + __builtin_ctzll(word));
+    }
+    for (; i < size; ++i) {
+        unsigned int byte = p[i];
+        size_t count = __builtin_popcount(byte);
+        if (index >= count) {
+            index -= count;
+            continue;
+        }
+        for (; index; --index)
+            byte &= byte - 1;
+        return static_cast<Id>((i << 3) + __builtin_ctz(byte));
+    }
+    return -1;
+}
+
+void
+bitmapAnd(Map *target, const Map *source)
+{
+    size_t size = target->size < source->size ? target->size : source->size;
+    andKernel(target->map, source->map, size);
+    if (static_cast<size_t>(target->size) > size)
+        memset(target->map + size, 0, target->size - size);
+}
+
+void
+bitmapSubtract(Map *target, const Map *source)
+{
+    size_t size = target->size < source->size ? target->size : source->size;
+    subtractKernel(target->map, source->map, size);
+}
+
+void
+bitmapOr(Map *target, const Map *source)
+{
+    if (target->size < source->size)
+        map_grow(target, source->size << 3);
+    orKernel(target->map, source->map, source->size);
+}
+
+}
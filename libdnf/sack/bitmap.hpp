@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __BITMAP_HPP
+#define __BITMAP_HPP
+
+#include <cstddef>
+#include <solv/bitmap.h>
+#include <solv/pooltypes.h>
+
+namespace libdnf {
+
+/**
+* @brief Word at a time replacements of libsolv map operations. They process 64 bits per step
+* and on x86_64 the loops are compiled for several instruction sets with the best one selected
+* at runtime. Semantics are the same as of the libsolv functions, including maps of different
+* sizes.
+*/
+
+/**
+* @brief Number of bits set in the map
+*/
+size_t bitmapCount(const Map *m);
+
+/**
+* @brief Returns true if no bit is set in the map
+*/
+bool bitmapEmpty(const Map *m);
+
+/**
+* @brief Returns the first set bit after previous or -1, previous -1 starts from the beginning
+*/
+Id bitmapNext(const Map *m, Id previous);
+
+/**
+* @brief Returns the index-th (counted from 0) set bit or -1 if there is not that many bits set
+*/
+Id bitmapNth(const Map *m, size_t index);
+
+/**
+* @brief Same as map_and(): target &= source, bits of target beyond the size of source are cleared
+*/
+void bitmapAnd(Map *target, const Map *source);
+
+/**
+* @brief Same as map_subtract(): target &= ~source
+*/
+void bitmapSubtract(Map *target, const Map *source);
+
+/**
+* @brief Same as map_or(): target |= source, target grows if it is smaller than source
+*/
+void bitmapOr(Map *target, const Map *source);
+
+}
+
+#endif /* __BITMAP_HPP */
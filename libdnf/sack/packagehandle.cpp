@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include <solv/evr.h>
+#include <solv/pool.h>
+#include <solv/repo.h>
+
+#include "packagehandle.hpp"
+#include "../dnf-sack-private.hpp"
+#include "../hy-package-private.hpp"
+
+namespace libdnf {
+
+Solvable *
+PackageHandle::getSolvable() const
+{
+    return pool_id2solvable(dnf_sack_get_pool(sack), id);
+}
+
+const char *
+PackageHandle::getName() const
+{
+    return pool_id2str(dnf_sack_get_pool(sack), getSolvable()->name);
+}
+
+const char *
+PackageHandle::getArch() const
+{
+    return pool_id2str(dnf_sack_get_pool(sack), getSolvable()->arch);
+}
+
+const char *
+PackageHandle::getEvr() const
+{
+    return pool_id2str(dnf_sack_get_pool(sack), getSolvable()->evr);
+}
+
+const char *
+PackageHandle::getReponame() const
+{
+    return getSolvable()->repo->name;
+}
+
+const char *
+PackageHandle::getNevra() const
+{
+    return pool_solvable2str(dnf_sack_get_pool(sack), getSolvable());
+}
+
+int
+PackageHandle::cmp(const PackageHandle & other) const
+{
+    Pool *pool1 = dnf_sack_get_pool(sack);
+    Pool *pool2 = dnf_sack_get_pool(other.sack);
+    Solvable *s1 = getSolvable();
+    Solvable *s2 = other.getSolvable();
+
+    int ret = strcmp(pool_id2str(pool1, s1->name), pool_id2str(pool2, s2->name));
+    if (ret)
+        return ret;
+    ret = pool_evrcmp_str(pool1, pool_id2str(pool1, s1->evr), pool_id2str(pool2, s2->evr),
+                          EVRCMP_COMPARE);
+    if (ret)
+        return ret;
+    return strcmp(pool_id2str(pool1, s1->arch), pool_id2str(pool2, s2->arch));
+}
+
+DnfPackage *
+PackageHandle::toDnfPackage() const
+{
+    return dnf_package_new(sack, id);
+}
+
+}
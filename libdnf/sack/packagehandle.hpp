@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __PACKAGE_HANDLE_HPP
+#define __PACKAGE_HANDLE_HPP
+
+#include <solv/pooltypes.h>
+#include <solv/solvable.h>
+
+#include "../dnf-types.h"
+
+namespace libdnf {
+
+/**
+* @brief Package referenced by its sack and solvable id. Unlike DnfPackage it is not a GObject,
+* it is copied by value and valid as long as the sack. Use toDnfPackage() where the C API needs
+* a DnfPackage.
+*/
+struct PackageHandle {
+public:
+    PackageHandle(DnfSack *sack, Id id) noexcept : sack(sack), id(id) {}
+
+    DnfSack *getSack() const noexcept { return sack; }
+    Id getId() const noexcept { return id; }
+    Solvable *getSolvable() const;
+
+    const char *getName() const;
+    const char *getArch() const;
+    const char *getEvr() const;
+    const char *getReponame() const;
+
+    /**
+    * @brief Returns name-[epoch:]version-release.arch in a pool temporary string
+    */
+    const char *getNevra() const;
+
+    /**
+    * @brief Same ordering as dnf_package_cmp(): by name, evr and arch
+    */
+    int cmp(const PackageHandle & other) const;
+
+    /**
+    * @brief Creates a new DnfPackage for the handle, the caller owns the reference
+    */
+    DnfPackage *toDnfPackage() const;
+
+    bool operator==(const PackageHandle & other) const noexcept
+    {
+        return sack == other.sack && id == other.id;
+    }
+    bool operator!=(const PackageHandle & other) const noexcept { return !(*this == other); }
+
+private:
+    DnfSack *sack;
+    Id id;
+};
+
+}
+
+#endif /* __PACKAGE_HANDLE_HPP */
@@ -18,14 +18,20 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <algorithm>
 #include <assert.h>
+#include <iterator>
+#include <vector>
 
+#include "bitmap.hpp"
 #include "packageset.hpp"
 #include "../dnf-sack.h"
-#include "../hy-util-private.hpp"
 
 namespace libdnf {
 
+/* Small sets are stored as a sorted vector of ids, large ones as a bitmap over the whole pool.
+ * A set becomes dense once it grows over sparseLimit() or when getMap() is called, as the caller
+ * may then modify the bitmap directly. Copies of small dense sets are sparse again. */
 class PackageSet::Impl {
 public:
     Impl(DnfSack* sack);
@@ -36,7 +42,12 @@ public:
 private:
     friend PackageSet;
     DnfSack *sack;
+    bool sparse;
+    std::vector<Id> ids;
     Map map;
+
+    size_t sparseLimit() const;
+    void densify();
 };
 
 PackageSet::PackageSet(DnfSack* sack) : pImpl(new Impl(sack)) {}
@@ -45,103 +56,163 @@ PackageSet::PackageSet(const PackageSet & pset): pImpl(new Impl(pset)) {}
 PackageSet::~PackageSet() = default;
 
 PackageSet::Impl::Impl(DnfSack* sack) :
-sack(sack)
+sack(sack), sparse(true)
 {
-    map_init(&map, dnf_sack_get_pool(sack)->nsolvables);
+    map_init(&map, 0);
 }
-PackageSet::Impl::Impl(DnfSack* sack, Map* map_source) : sack(sack)
+PackageSet::Impl::Impl(DnfSack* sack, Map* map_source) : sack(sack), sparse(false)
 {
     map_init_clone(&map, map_source);
 }
-PackageSet::Impl::Impl(const PackageSet & pset): sack(pset.pImpl->sack)
+PackageSet::Impl::Impl(const PackageSet & pset): sack(pset.pImpl->sack), sparse(true)
 {
-    map_init_clone(&map, &pset.pImpl->map);
+    auto & src = *pset.pImpl;
+    if (src.sparse) {
+        ids = src.ids;
+        map_init(&map, 0);
+    } else if (bitmapCount(&src.map) <= sparseLimit()) {
+        for (Id id = bitmapNext(&src.map, -1); id != -1; id = bitmapNext(&src.map, id))
+            ids.push_back(id);
+        map_init(&map, 0);
+    } else {
+        sparse = false;
+        map_init_clone(&map, &src.map);
+    }
 }
 PackageSet::Impl::~Impl() { map_free(&map); }
 
+size_t
+PackageSet::Impl::sparseLimit() const
+{
+    // the vector takes 32 bits per package, keep it under half the size of the bitmap
+    return std::max(dnf_sack_get_pool(sack)->nsolvables / 64, 32);
+}
+
+void
+PackageSet::Impl::densify()
+{
+    if (!sparse)
+        return;
+    map_free(&map);
+    map_init(&map, dnf_sack_get_pool(sack)->nsolvables);
+    for (auto id : ids)
+        MAPSET(&map, id);
+    std::vector<Id>().swap(ids);
+    sparse = false;
+}
+
 Id
 PackageSet::operator [](unsigned int index) const
 {
-    const unsigned char *ti = pImpl->map.map;
-    const unsigned char *end = ti + pImpl->map.size;
-    unsigned int enabled;
-    Id id;
-
-    while (ti < end) {
-        enabled = _BitCountLookup[*ti];
-
-        if (index >= enabled ){
-            index -= enabled;
-            ti++;
-            continue;
-        }
-        id = (ti - pImpl->map.map) << 3;
-
-        index++;
-        for (unsigned char byte = *ti; index; byte >>= 1) {
-            if ((byte & 0x01))
-                index--;
-            if (index)
-                id++;
-        }
-        return id;
-    }
-    id = -1;
-    return id;
+    if (pImpl->sparse)
+        return index < pImpl->ids.size() ? pImpl->ids[index] : -1;
+    return bitmapNth(&pImpl->map, index);
 }
 
 PackageSet &
 PackageSet::operator +=(const PackageSet & other)
 {
-    map_or(&pImpl->map, &other.pImpl->map);
+    auto & otherImpl = *other.pImpl;
+    if (pImpl->sparse && otherImpl.sparse) {
+        std::vector<Id> merged;
+        merged.reserve(pImpl->ids.size() + otherImpl.ids.size());
+        std::set_union(pImpl->ids.begin(), pImpl->ids.end(),
+                       otherImpl.ids.begin(), otherImpl.ids.end(), std::back_inserter(merged));
+        pImpl->ids.swap(merged);
+        if (pImpl->ids.size() > pImpl->sparseLimit())
+            pImpl->densify();
+        return *this;
+    }
+    pImpl->densify();
+    if (otherImpl.sparse) {
+        // the bitmap may have been made before the pool grew, bitmapOr() grows it as well
+        if (!otherImpl.ids.empty())
+            map_grow(&pImpl->map, otherImpl.ids.back() + 1);
+        for (auto id : otherImpl.ids)
+            MAPSET(&pImpl->map, id);
+    } else {
+        bitmapOr(&pImpl->map, &otherImpl.map);
+    }
     return *this;
 }
 
 void
 PackageSet::clear()
 {
-    map_empty(&pImpl->map);
+    if (pImpl->sparse)
+        pImpl->ids.clear();
+    else
+        map_empty(&pImpl->map);
 }
 
-void PackageSet::set(DnfPackage *pkg) { MAPSET(&pImpl->map, dnf_package_get_id(pkg)); }
-void PackageSet::set(Id id) { MAPSET(&pImpl->map, id); }
-bool PackageSet::has(DnfPackage *pkg) const { return MAPTST(&pImpl->map, dnf_package_get_id(pkg)); }
-bool PackageSet::has(Id id) const { return MAPTST(&pImpl->map, id); }
-void PackageSet::remove(Id id) { MAPCLR(&pImpl->map, id); }
-Map *PackageSet::getMap() const { return &pImpl->map; }
-DnfSack *PackageSet::getSack() const { return pImpl->sack; }
-size_t PackageSet::size() const { return map_count(&pImpl->map); }
+void PackageSet::set(DnfPackage *pkg) { set(dnf_package_get_id(pkg)); }
 
-Id PackageSet::next(Id previous) const
+void
+PackageSet::set(Id id)
 {
-    const unsigned char *ti = pImpl->map.map;
-    const unsigned char *end = ti + pImpl->map.size;
-    Id id;
-
-    if (previous >= 0) {
-        ti += previous >> 3;
-        unsigned char byte = *ti; // byte with the previous match
-        byte >>= (previous & 7) + 1; // shift away all previous 1 bits
-
-        for (id = previous + 1; byte; byte >>= 1, id++)
-            if (byte & 0x01)
-                return id;
-        ti++;
+    if (!pImpl->sparse) {
+        MAPSET(&pImpl->map, id);
+        return;
     }
+    auto & ids = pImpl->ids;
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it != ids.end() && *it == id)
+        return;
+    ids.insert(it, id);
+    if (ids.size() > pImpl->sparseLimit())
+        pImpl->densify();
+}
+
+bool PackageSet::has(DnfPackage *pkg) const { return has(dnf_package_get_id(pkg)); }
 
-    while (ti < end) {
-
-        if (!*ti){
-            ti++;
-            continue;
-        }
-        id = (ti - pImpl->map.map) << 3;
-        for (unsigned char byte = *ti; 1; byte >>= 1, id++) {
-            if (byte & 0x01)
-                return id;
-        }
+bool
+PackageSet::has(Id id) const
+{
+    if (pImpl->sparse)
+        return std::binary_search(pImpl->ids.begin(), pImpl->ids.end(), id);
+    return MAPTST(&pImpl->map, id);
+}
+
+void
+PackageSet::remove(Id id)
+{
+    if (!pImpl->sparse) {
+        MAPCLR(&pImpl->map, id);
+        return;
     }
-    return -1;
+    auto & ids = pImpl->ids;
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it != ids.end() && *it == id)
+        ids.erase(it);
+}
+
+Map *
+PackageSet::getMap() const
+{
+    pImpl->densify();
+    return &pImpl->map;
+}
+
+bool PackageSet::isDense() const noexcept { return !pImpl->sparse; }
+
+DnfSack *PackageSet::getSack() const { return pImpl->sack; }
+
+size_t
+PackageSet::size() const
+{
+    if (pImpl->sparse)
+        return pImpl->ids.size();
+    return bitmapCount(&pImpl->map);
+}
+
+Id
+PackageSet::next(Id previous) const
+{
+    if (!pImpl->sparse)
+        return bitmapNext(&pImpl->map, previous);
+    auto & ids = pImpl->ids;
+    auto it = std::upper_bound(ids.begin(), ids.end(), previous);
+    return it == ids.end() ? -1 : *it;
 }
 
 }
@@ -21,6 +21,7 @@
 #ifndef __PACKAGE_SET_HPP
 #define __PACKAGE_SET_HPP
 
+#include <iterator>
 #include <memory>
 #include <solv/bitmap.h>
 #include "../dnf-types.h"
@@ -43,7 +44,16 @@ public:
     bool has(DnfPackage *pkg) const;
     bool has(Id id) const;
     void remove(Id id);
+    /**
+    * @brief Returns the bitmap of the set. A sparse set is converted to a bitmap first, so the
+    * call modifies the set although it is const and must not run concurrently with any other
+    * use of the set.
+    */
     Map *getMap() const;
+    /**
+    * @brief Returns true if the set is stored as a bitmap, getMap() then doesn't modify it
+    */
+    bool isDense() const noexcept;
     DnfSack *getSack() const;
     size_t size() const;
 
@@ -55,6 +65,33 @@ public:
     */
     Id next(Id previous) const;
 
+    /**
+    * @brief Forward iterator over ids in the set in ascending order. Adding or removing ids
+    * other than the current one invalidates it.
+    */
+    class const_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Id value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Id * pointer;
+        typedef const Id & reference;
+
+        const_iterator(const PackageSet *pset, Id id) noexcept : pset(pset), id(id) {}
+        reference operator *() const noexcept { return id; }
+        const_iterator & operator ++() { id = pset->next(id); return *this; }
+        const_iterator operator ++(int) { auto ret = *this; ++*this; return ret; }
+        bool operator ==(const const_iterator & other) const noexcept { return id == other.id; }
+        bool operator !=(const const_iterator & other) const noexcept { return id != other.id; }
+
+    private:
+        const PackageSet *pset;
+        Id id;
+    };
+
+    const_iterator begin() const { return const_iterator(this, next(-1)); }
+    const_iterator end() const noexcept { return const_iterator(this, -1); }
+
 private:
     class Impl;
     std::unique_ptr<Impl> pImpl;
@@ -20,7 +20,13 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <fnmatch.h>
+#include <functional>
+#include <mutex>
+#include <string>
 #include <vector>
 
 extern "C" {
@@ -41,8 +47,11 @@ extern "C" {
 #include "../goal/IdQueue.hpp"
 #include "../goal/Goal-private.hpp"
 #include "advisory.hpp"
+#include "advisoryindex.hpp"
 #include "advisorypkg.hpp"
+#include "bitmap.hpp"
 #include "packageset.hpp"
+#include "stringmatcher.hpp"
 
 #include "libdnf/repo/solvable/Dependency.hpp"
 #include "libdnf/repo/solvable/DependencyContainer.hpp"
@@ -108,26 +117,6 @@ NevraID::parse(Pool * pool, const char * nevraPattern)
     return true;
 }
 
-static bool
-nevraIDSorter(const NevraID & first, const NevraID & second)
-{
-    if (first.name != second.name)
-        return first.name < second.name;
-    if (first.arch != second.arch)
-        return first.arch < second.arch;
-    return first.evr < second.evr;
-}
-
-static bool
-nevraCompareLowerSolvable(const NevraID &first, const Solvable &s)
-{
-    if (first.name != s.name)
-        return first.name < s.name;
-    if (first.arch != s.arch)
-        return first.arch < s.arch;
-    return first.evr < s.evr;
-}
-
 static bool
 match_type_num(int keyname) {
     switch (keyname) {
@@ -390,39 +379,104 @@ pool_solvable_epoch_optional_2str(Pool *pool, const Solvable *s, gboolean with_e
     return output_string;
 }
 
-static int
-filter_latest_sortcmp(const void *ap, const void *bp, void *dp)
+/**
+* @brief Appends packages of pset to samename ordered by name, evr (newest first) and id, with
+* byArch by name, arch, evr and id. See dnf_sack_get_evr_order().
+*/
+static void
+orderByNameEvr(DnfSack *sack, PackageSet *pset, bool byArch, Queue *samename)
 {
-    auto pool = static_cast<Pool *>(dp);
-    Solvable *sa = pool->solvables + *(Id *)ap;
-    Solvable *sb = pool->solvables + *(Id *)bp;
-    int r;
-    r = sa->name - sb->name;
-    if (r)
-        return r;
-    r = pool_evrcmp(pool, sb->evr, sa->evr, EVRCMP_COMPARE);
-    if (r)
-        return r;
-    return *(Id *)ap - *(Id *)bp;
+    Pool *pool = dnf_sack_get_pool(sack);
+    size_t count = pset->size();
+    int start = samename->count;
+
+    queue_prealloc(samename, count);
+    // a few packages are cheaper to sort, otherwise they are picked from the order of the pool
+    if (count * 32 < static_cast<size_t>(pool->nsolvables)) {
+        for (Id id : *pset)
+            queue_push(samename, id);
+        dnf_sack_sort_evr_order(sack, samename->elements + start, count, byArch);
+        return;
+    }
+    int orderCount;
+    const Id *order = dnf_sack_get_evr_order(sack, byArch, &orderCount);
+    auto map = pset->getMap();
+    for (int i = 0; i < orderCount; ++i) {
+        if (MAPTST(map, order[i]))
+            queue_push(samename, order[i]);
+    }
 }
 
-static int
-filter_latest_sortcmp_byarch(const void *ap, const void *bp, void *dp)
-{
-    auto pool = static_cast<Pool *>(dp);
-    Solvable *sa = pool->solvables + *(Id *)ap;
-    Solvable *sb = pool->solvables + *(Id *)bp;
-    int r;
-    r = sa->name - sb->name;
-    if (r)
-        return r;
-    r = sa->arch - sb->arch;
-    if (r)
-        return r;
-    r = pool_evrcmp(pool, sb->evr, sa->evr, EVRCMP_COMPARE);
-    if (r)
-        return r;
-    return *(Id *)ap - *(Id *)bp;
+/**
+* @brief Same as what_upgrades() or what_downgrades() with installed packages of the same name
+* listed in the order of dnf_sack_get_evr_order(). No whatprovides lookup is needed and evrs
+* are compared by their ranks.
+*/
+static Id
+whatUpdownIn(Pool *pool, const int *ranks, Id pkg, const std::vector<Id> & installed,
+             bool downgrade)
+{
+    Solvable *s = pool_id2solvable(pool, pkg);
+    Id l = 0;
+
+    for (Id p : installed) {
+        Solvable *updated = pool_id2solvable(pool, p);
+        if (downgrade) {
+            if (updated->arch != s->arch)
+                continue;
+            if (ranks[p] <= ranks[pkg])
+                return 0;
+            if (l == 0 || ranks[p] < ranks[l])
+                l = p;
+        } else {
+            if (updated->arch != s->arch &&
+                updated->arch != ARCH_NOARCH &&
+                s->arch != ARCH_NOARCH)
+                continue;
+            if (ranks[p] >= ranks[pkg])
+                return 0;
+            if (l == 0 || ranks[p] > ranks[l])
+                l = p;
+        }
+    }
+    return l;
+}
+
+/**
+* @brief Walks packages by name in the order of dnf_sack_get_evr_order() and calls
+* fn(pkg, what) for each available package in candidates (all if NULL) that upgrades or
+* downgrades the installed package what
+*/
+static void
+forEachUpdown(DnfSack *sack, bool downgrade, const Map *candidates,
+              const std::function<void(Id pkg, Id what)> & fn)
+{
+    Pool *pool = dnf_sack_get_pool(sack);
+    int count;
+    const Id *order = dnf_sack_get_evr_order(sack, FALSE, &count);
+    const int *ranks = dnf_sack_get_evr_ranks(sack);
+    std::vector<Id> installed;
+
+    for (int start = 0, end; start < count; start = end) {
+        Id name = pool->solvables[order[start]].name;
+        installed.clear();
+        for (end = start; end < count && pool->solvables[order[end]].name == name; ++end) {
+            if (pool->solvables[order[end]].repo == pool->installed)
+                installed.push_back(order[end]);
+        }
+        if (installed.empty())
+            continue;
+        for (int i = start; i < end; ++i) {
+            Id p = order[i];
+            if (pool->solvables[p].repo == pool->installed)
+                continue;
+            if (candidates && !MAPTST(candidates, p))
+                continue;
+            Id what = whatUpdownIn(pool, ranks, p, installed, downgrade);
+            if (what)
+                fn(p, what);
+        }
+    }
 }
 
 static void
@@ -484,13 +538,11 @@ advisoryPkgSort(const AdvisoryPkg &first, const AdvisoryPkg &second)
 }
 
 static bool
-advisoryPkgCompareSolvable(const AdvisoryPkg &first, const Solvable &s)
+advisoryEntryCompareNameArch(const AdvisoryIndex::Entry &first, const AdvisoryIndex::Entry &second)
 {
-    if (first.getName() != s.name)
-        return first.getName() < s.name;
-    if (first.getEVR() != s.evr)
-        return first.getEVR() < s.evr;
-    return first.getArch() < s.arch;
+    if (first.name != second.name)
+        return first.name < second.name;
+    return first.arch < second.arch;
 }
 
 static bool
@@ -516,6 +568,72 @@ copyFilterChar(const char * match, int keyname)
     return strcpy(matchNew, match);
 }
 
+/**
+* @brief Filters that look at the packages left in the query by the previous filters, not only at
+* the package being tested. They can not be moved over other filters.
+*/
+static bool
+filterIsOrderDependent(const Filter & f)
+{
+    switch (f.getKeyname()) {
+        case HY_PKG_LATEST:
+        case HY_PKG_LATEST_PER_ARCH:
+        case HY_PKG_DOWNGRADABLE:
+        case HY_PKG_UPGRADABLE:
+            return true;
+        case HY_PKG_ADVISORY:
+        case HY_PKG_ADVISORY_BUG:
+        case HY_PKG_ADVISORY_CVE:
+        case HY_PKG_ADVISORY_SEVERITY:
+        case HY_PKG_ADVISORY_TYPE:
+            return f.getCmpType() & (HY_GT | HY_LT);
+        default:
+            return false;
+    }
+}
+
+/**
+* @brief Rough estimate of the cost of a filter, cheap and usually selective filters get low values
+*/
+static int
+filterCost(const Filter & f)
+{
+    switch (f.getKeyname()) {
+        case HY_PKG:
+        case HY_PKG_ALL:
+        case HY_PKG_EMPTY:
+            return 0;
+        case HY_PKG_NAME:
+            if ((f.getCmpType() & HY_EQ) && !(f.getCmpType() & HY_ICASE))
+                return 1;
+            return 2;
+        case HY_PKG_REPONAME:
+        case HY_PKG_ARCH:
+            return 1;
+        case HY_PKG_EPOCH:
+        case HY_PKG_EVR:
+        case HY_PKG_NEVRA:
+        case HY_PKG_VERSION:
+        case HY_PKG_RELEASE:
+        case HY_PKG_SOURCERPM:
+            return 2;
+        case HY_PKG_CONFLICTS:
+        case HY_PKG_OBSOLETES:
+        case HY_PKG_PROVIDES:
+        case HY_PKG_ENHANCES:
+        case HY_PKG_RECOMMENDS:
+        case HY_PKG_REQUIRES:
+        case HY_PKG_SUGGESTS:
+        case HY_PKG_SUPPLEMENTS:
+        case HY_PKG_DOWNGRADES:
+        case HY_PKG_UPGRADES:
+            return 3;
+        default:
+            // location, advisories and filters going through dataiterator (file, summary, ...)
+            return 4;
+    }
+}
+
 class Filter::Impl {
 public:
     ~Impl();
@@ -635,7 +753,17 @@ private:
     int flags;
     std::unique_ptr<PackageSet> result;
     std::vector<Filter> filters;
+    QueryTraceCallback traceCallback;
+    bool profiling{false};
+    std::vector<QueryFilterProfile> profile;
+    /* set by filters answered from a sack index, reset before each filter */
+    bool indexUsed{false};
+    unsigned int parallelThreads{0};
+    size_t parallelMinPackages{0};
     void apply();
+    void applyFilter(const Filter & f, Map *m);
+    bool buildCacheKey(std::string & key) const;
+    void forEachSlice(const std::function<void(Id first, Id last)> & fn);
 
     /**
     * @brief It accepts strings of whole NEVRA and apply them to the query. It requires full
@@ -680,6 +808,10 @@ Query::Impl::Impl(const Query::Impl & src)
 , sack(src.sack)
 , flags(src.flags)
 , filters(src.filters)
+, traceCallback(src.traceCallback)
+, profiling(src.profiling)
+, parallelThreads(src.parallelThreads)
+, parallelMinPackages(src.parallelMinPackages)
 {
     if (src.result) {
         result.reset(new PackageSet(*src.result.get()));
@@ -693,6 +825,12 @@ Query::Impl::operator=(const Query::Impl & src)
     sack = src.sack;
     flags = src.flags;
     filters = src.filters;
+    traceCallback = src.traceCallback;
+    profiling = src.profiling;
+    // the records belong to the filters the source has run, not to this query
+    profile.clear();
+    parallelThreads = src.parallelThreads;
+    parallelMinPackages = src.parallelMinPackages;
     if (src.result) {
         result.reset(new PackageSet(*src.result.get()));
     } else {
@@ -708,6 +846,35 @@ Query::~Query() = default;
 
 Query & Query::operator=(const Query & query_src) { *pImpl = *query_src.pImpl; return *this; }
 
+void
+Query::setTraceCallback(QueryTraceCallback callback)
+{
+    pImpl->traceCallback = std::move(callback);
+}
+
+void
+Query::setProfiling(bool enabled)
+{
+    pImpl->profiling = enabled;
+    if (!enabled)
+        pImpl->profile.clear();
+}
+
+bool Query::getProfiling() const noexcept { return pImpl->profiling; }
+
+void
+Query::setParallel(unsigned int threads, size_t minPackages)
+{
+    pImpl->parallelThreads = threads;
+    pImpl->parallelMinPackages = minPackages;
+}
+
+const std::vector<QueryFilterProfile> &
+Query::getProfile() const noexcept
+{
+    return pImpl->profile;
+}
+
 Map *
 Query::getResult() noexcept
 {
@@ -732,6 +899,7 @@ Query::clear()
     pImpl->applied = false;
     pImpl->result.reset();
     pImpl->filters.clear();
+    pImpl->profile.clear();
 }
 
 size_t
@@ -912,40 +1080,25 @@ Query::Impl::filterNevraStrict(int cmpType, const char **matches)
     }
     Map nevraResult;
     map_init(&nevraResult, pool->nsolvables);
+    auto resultMap = result->getMap();
 
-    if (compareSet.size() > 1) {
-        std::sort(compareSet.begin(), compareSet.end(), nevraIDSorter);
-
-        Id id = -1;
-        while (true) {
-            id = result->next(id);
-            if (id == -1)
-                break;
-            Solvable* s = pool_id2solvable(pool, id);
-            auto low = std::lower_bound(compareSet.begin(), compareSet.end(), *s,
-                                        nevraCompareLowerSolvable);
-            if (low != compareSet.end() && low->name == s->name && low->evr == s->evr &&
-                low->arch == s->arch) {
-                MAPSET(&nevraResult, id);
-            }
-        }
-    } else {
-        auto nevraId = compareSet[0];
-        Id id = -1;
-        while (true) {
-            id = result->next(id);
-            if (id == -1)
-                break;
+    for (auto & nevraId : compareSet) {
+        int count;
+        const Id *ids = dnf_sack_get_name_index(sack, nevraId.name, &count);
+        for (int i = 0; i < count; ++i) {
+            Id id = ids[i];
+            if (!MAPTST(resultMap, id))
+                continue;
             Solvable* s = pool_id2solvable(pool, id);
-            if (nevraId.name == s->name && nevraId.evr == s->evr && nevraId.arch == s->arch) {
+            if (nevraId.evr == s->evr && nevraId.arch == s->arch) {
                 MAPSET(&nevraResult, id);
             }
         }
     }
     if (cmpType & HY_NOT)
-        map_subtract(result->getMap(), &nevraResult);
+        bitmapSubtract(result->getMap(), &nevraResult);
     else
-        map_and(result->getMap(), &nevraResult);
+        bitmapAnd(result->getMap(), &nevraResult);
     map_free(&nevraResult);
 }
 
@@ -967,7 +1120,7 @@ Query::Impl::initResult()
     if (!(flags & HY_IGNORE_EXCLUDES)) {
         dnf_sack_recompute_considered(sack);
         if (pool->considered)
-            map_and(result->getMap(), pool->considered);
+            bitmapAnd(result->getMap(), pool->considered);
     }
 }
 
@@ -981,6 +1134,72 @@ Query::Impl::filterPkg(const Filter & f, Map *m)
     map_init_clone(m, dnf_packageset_get_map(f.getMatches()[0].pset));
 }
 
+namespace {
+
+/* Slices of one forEachSlice() call, taken by its workers until none is left. */
+struct QuerySliceJob {
+    const std::function<void(Id first, Id last)> *fn;
+    Id nsolvables;
+    Id sliceSize;
+    std::atomic<Id> next{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+    unsigned int running;
+};
+
+void
+querySliceWorkerCb(gpointer data, gpointer user_data)
+{
+    auto job = static_cast<QuerySliceJob *>(data);
+    for (Id first; (first = job->next.fetch_add(job->sliceSize)) < job->nsolvables;)
+        (*job->fn)(first, std::min(first + job->sliceSize, job->nsolvables));
+
+    std::lock_guard<std::mutex> lock(job->mutex);
+    if (--job->running == 0)
+        job->finished.notify_one();
+}
+
+/* Process-wide pool shared by all queries, its threads are started once and kept. */
+GThreadPool *
+getQueryThreadPool()
+{
+    static GThreadPool *threadPool = g_thread_pool_new(
+        querySliceWorkerCb, NULL, std::max(g_get_num_processors(), 2u), FALSE, NULL);
+    return threadPool;
+}
+
+}
+
+/**
+* @brief Calls fn for ranges [first, last) covering all solvable ids. The ranges are processed
+* on a thread pool if parallel evaluation is enabled and the result is large enough, fn must then
+* only read the pool and set bits of ids in its range.
+*/
+void
+Query::Impl::forEachSlice(const std::function<void(Id first, Id last)> & fn)
+{
+    Id nsolvables = dnf_sack_get_pool(sack)->nsolvables;
+    GThreadPool *threadPool = getQueryThreadPool();
+    if (parallelThreads < 2 || result->size() < parallelMinPackages || !threadPool) {
+        fn(0, nsolvables);
+        return;
+    }
+    // workers only read the result, a sparse one would be converted by the first getMap() call
+    assert(result->isDense());
+
+    // a few slices per thread balance the load, 64 ids are one word of the bitmap
+    QuerySliceJob job;
+    job.fn = &fn;
+    job.nsolvables = nsolvables;
+    job.sliceSize = (nsolvables / (parallelThreads * 4) + 64) & ~63;
+    job.running = parallelThreads;
+    for (unsigned int i = 0; i < parallelThreads; ++i)
+        g_thread_pool_push(threadPool, &job, NULL);
+
+    std::unique_lock<std::mutex> lock(job.mutex);
+    job.finished.wait(lock, [&job] { return job.running == 0; });
+}
+
 void
 Query::Impl::filterRcoReldep(const Filter & f, Map *m)
 {
@@ -988,30 +1207,34 @@ Query::Impl::filterRcoReldep(const Filter & f, Map *m)
 
     Pool *pool = dnf_sack_get_pool(sack);
     Id rco_key = reldep_keyname2id(f.getKeyname());
-    Queue rco;
     auto resultPset = result.get();
 
-    queue_init(&rco);
-    Id resultId = -1;
-    while ((resultId = resultPset->next(resultId)) != -1) {
-        Solvable *s = pool_id2solvable(pool, resultId );
-        for (auto match : f.getMatches()) {
-            Id reldepFilterId = match.reldep;
-
-            queue_empty(&rco);
-            solvable_lookup_idarray(s, rco_key, &rco);
-            for (int j = 0; j < rco.count; ++j) {
-                Id reldepIdFromSolvable = rco.elements[j];
-
-                if (pool_match_dep(pool, reldepFilterId, reldepIdFromSolvable )) {
-                    MAPSET(m, resultId );
-                    goto nextId;
+    // internalize repos now, the dependency arrays may be read from several threads
+    dnf_sack_make_provides_ready(sack);
+    forEachSlice([&](Id first, Id last) {
+        Queue rco;
+        queue_init(&rco);
+        Id resultId = first - 1;
+        while ((resultId = resultPset->next(resultId)) != -1 && resultId < last) {
+            Solvable *s = pool_id2solvable(pool, resultId );
+            for (auto match : f.getMatches()) {
+                Id reldepFilterId = match.reldep;
+
+                queue_empty(&rco);
+                solvable_lookup_idarray(s, rco_key, &rco);
+                for (int j = 0; j < rco.count; ++j) {
+                    Id reldepIdFromSolvable = rco.elements[j];
+
+                    if (pool_match_dep(pool, reldepFilterId, reldepIdFromSolvable )) {
+                        MAPSET(m, resultId );
+                        goto nextId;
+                    }
                 }
             }
+            nextId:;
         }
-        nextId:;
-    }
-    queue_free(&rco);
+        queue_free(&rco);
+    });
 }
 
 void
@@ -1022,91 +1245,38 @@ Query::Impl::filterName(const Filter & f, Map *m)
     auto resultPset = result.get();
 
     if ((cmpType & HY_EQ) && !(cmpType & HY_ICASE)) {
-        Id match_name_id = 0;
-        if (f.getMatches().size() < 3) {
-            for (auto match_union : f.getMatches()) {
-                const char *match = match_union.str;
-                match_name_id = pool_str2id(pool, match, 0);
-                if (match_name_id == 0)
-                    continue;
-                Id id = -1;
-                while (true) {
-                    id = resultPset->next(id);
-                    if (id == -1)
-                        break;
-                    Solvable *s = pool_id2solvable(pool, id);
-                    if (match_name_id == s->name)
-                        MAPSET(m, id);
-                    continue;
-                }
-            }
-            return;
-        }
-        std::vector<Id> names;
+        // exact names are looked up in the per-sack name index, cost is O(matches)
+        indexUsed = true;
+        auto resultMap = resultPset->getMap();
         for (auto match_union : f.getMatches()) {
             const char *match = match_union.str;
-            match_name_id = pool_str2id(pool, match, 0);
+            Id match_name_id = pool_str2id(pool, match, 0);
             if (match_name_id == 0)
                 continue;
-            names.push_back(match_name_id);
-        }
-        std::sort(names.begin(), names.end());
-        Id id = -1;
-        while (true) {
-            id = resultPset->next(id);
-            if (id == -1)
-                break;
-            Solvable* s = pool_id2solvable(pool, id);
-            auto low = std::lower_bound(names.begin(), names.end(), s->name);
-            if (low != names.end() && (*low) == s->name) {
-                MAPSET(m, id);
+            int count;
+            const Id *ids = dnf_sack_get_name_index(sack, match_name_id, &count);
+            for (int i = 0; i < count; ++i) {
+                if (MAPTST(resultMap, ids[i]))
+                    MAPSET(m, ids[i]);
             }
         }
         return;
     }
-    
-    for (auto match_union : f.getMatches()) {
-        const char *match = match_union.str;
-        Id id = -1;
+
+    forEachSlice([&](Id first, Id last) {
+        PoolStringMatcher matcher(pool, cmpType);
+        for (auto match_union : f.getMatches())
+            matcher.addPattern(match_union.str);
+
+        Id id = first - 1;
         while (true) {
             id = resultPset->next(id);
-            if (id == -1)
+            if (id == -1 || id >= last)
                 break;
-
-            Solvable *s = pool_id2solvable(pool, id);
-            if (cmpType & HY_ICASE) {
-                const char *name = pool_id2str(pool, s->name);
-                if (cmpType & HY_SUBSTR) {
-                    if (strcasestr(name, match) != NULL)
-                        MAPSET(m, id);
-                    continue;
-                }
-                if (cmpType & HY_EQ) {
-                    if (strcasecmp(name, match) == 0)
-                        MAPSET(m, id);
-                    continue;
-                }
-                if (cmpType & HY_GLOB) {
-                    if (fnmatch(match, name, FNM_CASEFOLD) == 0)
-                        MAPSET(m, id);
-                    continue;
-                }
-                continue;
-            }
-
-            const char *name = pool_id2str(pool, s->name);
-            if (cmpType & HY_GLOB) {
-                if (fnmatch(match, name, 0) == 0)
-                    MAPSET(m, id);
-                continue;
-            }
-            if (cmpType & HY_SUBSTR) {
-                if (strstr(name, match) != NULL)
-                    MAPSET(m, id);
-                continue;
-            }
+            if (matcher.match(pool_id2solvable(pool, id)->name))
+                MAPSET(m, id);
         }
-    }
+    });
 }
 
 void
@@ -1149,19 +1319,21 @@ Query::Impl::filterEvr(const Filter & f, Map *m)
 
     for (auto match : f.getMatches()) {
         Id match_evr = pool_str2id(pool, match.str, 1);
+        // compare each distinct evr of the candidates once
+        auto matchEvr = [&](Id evr) {
+            int cmp = pool_evrcmp(pool, evr, match_evr, EVRCMP_COMPARE);
+            return (cmp > 0 && cmp_type & HY_GT) || (cmp < 0 && cmp_type & HY_LT) ||
+                (cmp == 0 && cmp_type & HY_EQ);
+        };
+        StringIdCache cache(pool);
 
         Id id = -1;
         while (true) {
             id = resultPset->next(id);
             if (id == -1)
                 break;
-            Solvable *s = pool_id2solvable(pool, id);
-            int cmp = pool_evrcmp(pool, s->evr, match_evr, EVRCMP_COMPARE);
-
-            if ((cmp > 0 && cmp_type & HY_GT) || (cmp < 0 && cmp_type & HY_LT) ||
-                (cmp == 0 && cmp_type & HY_EQ)) {
+            if (cache.get(pool_id2solvable(pool, id)->evr, matchEvr))
                 MAPSET(m, id);
-            }
         }
     }
 }
@@ -1211,39 +1383,58 @@ Query::Impl::filterVersion(const Filter & f, Map *m)
     int cmp_type = f.getCmpType();
     auto resultPset = result.get();
 
-    for (auto match_in : f.getMatches()) {
-        const char *match = match_in.str;
-        char *filter_vr = solv_dupjoin(match, "-0", NULL);
-
+    if (cmp_type & HY_GLOB) {
+        // the version is a part of the evr, match each distinct evr once
+        PoolStringMatcher matcher(pool, HY_GLOB);
+        for (auto match_in : f.getMatches())
+            matcher.addPattern(match_in.str);
+        auto getVersion = [pool](Id evr) {
+            char *e, *v, *r;
+            pool_split_evr(pool, pool_id2str(pool, evr), &e, &v, &r);
+            return v;
+        };
         Id id = -1;
         while (true) {
             id = resultPset->next(id);
             if (id == -1)
                 break;
-            char *e, *v, *r;
             Solvable *s = pool_id2solvable(pool, id);
-            if (s->evr == ID_EMPTY)
-                continue;
-            const char *evr = pool_id2str(pool, s->evr);
-
-            pool_split_evr(pool, evr, &e, &v, &r);
-
-            if (cmp_type & HY_GLOB) {
-                if (fnmatch(match, v, 0) == 0)
-                    MAPSET(m, id);
-                continue;
-            }
+            if (s->evr != ID_EMPTY && matcher.match(s->evr, getVersion))
+                MAPSET(m, id);
+        }
+        return;
+    }
 
-            char *vr = pool_tmpjoin(pool, v, "-0", NULL);
-            int cmp = pool_evrcmp_str(pool, vr, filter_vr, EVRCMP_COMPARE);
+    // packages share evrs a lot, compare each distinct evr once against all the patterns
+    std::vector<char *> filterVrs;
+    for (auto match_in : f.getMatches())
+        filterVrs.push_back(solv_dupjoin(match_in.str, "-0", NULL));
+    auto matchVersion = [&](Id evr) {
+        char *e, *v, *r;
+        pool_split_evr(pool, pool_id2str(pool, evr), &e, &v, &r);
+        char *vr = pool_tmpjoin(pool, v, "-0", NULL);
+        for (auto filterVr : filterVrs) {
+            int cmp = pool_evrcmp_str(pool, vr, filterVr, EVRCMP_COMPARE);
             if ((cmp > 0 && cmp_type & HY_GT) ||
                 (cmp < 0 && cmp_type & HY_LT) ||
-                (cmp == 0 && cmp_type & HY_EQ)) {
-                MAPSET(m, id);
-            }
+                (cmp == 0 && cmp_type & HY_EQ))
+                return true;
         }
-        solv_free(filter_vr);
+        return false;
+    };
+
+    StringIdCache cache(pool);
+    Id id = -1;
+    while (true) {
+        id = resultPset->next(id);
+        if (id == -1)
+            break;
+        Solvable *s = pool_id2solvable(pool, id);
+        if (s->evr != ID_EMPTY && cache.get(s->evr, matchVersion))
+            MAPSET(m, id);
     }
+    for (auto filterVr : filterVrs)
+        solv_free(filterVr);
 }
 
 void
@@ -1253,41 +1444,58 @@ Query::Impl::filterRelease(const Filter & f, Map *m)
     int cmp_type = f.getCmpType();
     auto resultPset = result.get();
 
-    for (auto match_in : f.getMatches()) {
-        const char *match = match_in.str;
-        char *filter_vr = solv_dupjoin("0-", match, NULL);
-
+    if (cmp_type & HY_GLOB) {
+        // the release is a part of the evr, match each distinct evr once
+        PoolStringMatcher matcher(pool, HY_GLOB);
+        for (auto match_in : f.getMatches())
+            matcher.addPattern(match_in.str);
+        auto getRelease = [pool](Id evr) {
+            char *e, *v, *r;
+            pool_split_evr(pool, pool_id2str(pool, evr), &e, &v, &r);
+            return r;
+        };
         Id id = -1;
         while (true) {
             id = resultPset->next(id);
             if (id == -1)
                 break;
-            char *e, *v, *r;
             Solvable *s = pool_id2solvable(pool, id);
-            if (s->evr == ID_EMPTY)
-                continue;
-            const char *evr = pool_id2str(pool, s->evr);
-
-            pool_split_evr(pool, evr, &e, &v, &r);
-
-            if (cmp_type & HY_GLOB) {
-                if (fnmatch(match, r, 0) == 0)
-                    MAPSET(m, id);
-                continue;
-            }
-
-            char *vr = pool_tmpjoin(pool, "0-", r, NULL);
-
-            int cmp = pool_evrcmp_str(pool, vr, filter_vr, EVRCMP_COMPARE);
+            if (s->evr != ID_EMPTY && matcher.match(s->evr, getRelease))
+                MAPSET(m, id);
+        }
+        return;
+    }
 
+    // packages share evrs a lot, compare each distinct evr once against all the patterns
+    std::vector<char *> filterVrs;
+    for (auto match_in : f.getMatches())
+        filterVrs.push_back(solv_dupjoin("0-", match_in.str, NULL));
+    auto matchRelease = [&](Id evr) {
+        char *e, *v, *r;
+        pool_split_evr(pool, pool_id2str(pool, evr), &e, &v, &r);
+        char *vr = pool_tmpjoin(pool, "0-", r, NULL);
+        for (auto filterVr : filterVrs) {
+            int cmp = pool_evrcmp_str(pool, vr, filterVr, EVRCMP_COMPARE);
             if ((cmp > 0 && cmp_type & HY_GT) ||
                 (cmp < 0 && cmp_type & HY_LT) ||
-                (cmp == 0 && cmp_type & HY_EQ)) {
-                MAPSET(m, id);
-            }
+                (cmp == 0 && cmp_type & HY_EQ))
+                return true;
         }
-        solv_free(filter_vr);
+        return false;
+    };
+
+    StringIdCache cache(pool);
+    Id id = -1;
+    while (true) {
+        id = resultPset->next(id);
+        if (id == -1)
+            break;
+        Solvable *s = pool_id2solvable(pool, id);
+        if (s->evr != ID_EMPTY && cache.get(s->evr, matchRelease))
+            MAPSET(m, id);
     }
+    for (auto filterVr : filterVrs)
+        solv_free(filterVr);
 }
 
 void
@@ -1298,6 +1506,21 @@ Query::Impl::filterArch(const Filter & f, Map *m)
     Id match_arch_id = 0;
     auto resultPset = result.get();
 
+    if (cmp_type & HY_GLOB) {
+        PoolStringMatcher matcher(pool, HY_GLOB);
+        for (auto match_in : f.getMatches())
+            matcher.addPattern(match_in.str);
+        Id id = -1;
+        while (true) {
+            id = resultPset->next(id);
+            if (id == -1)
+                break;
+            if (matcher.match(pool_id2solvable(pool, id)->arch))
+                MAPSET(m, id);
+        }
+        return;
+    }
+
     for (auto match_in : f.getMatches()) {
         const char *match = match_in.str;
         if (cmp_type & HY_EQ) {
@@ -1317,12 +1540,6 @@ Query::Impl::filterArch(const Filter & f, Map *m)
                     MAPSET(m, id);
                 continue;
             }
-            const char *arch = pool_id2str(pool, s->arch);
-            if (cmp_type & HY_GLOB) {
-                if (fnmatch(match, arch, 0) == 0)
-                    MAPSET(m, id);
-                continue;
-            }
         }
     }
 }
@@ -1483,88 +1700,79 @@ void
 Query::Impl::filterAdvisory(const Filter & f, Map *m, int keyname)
 {
     Pool *pool = dnf_sack_get_pool(sack);
-    std::vector<AdvisoryPkg> pkgs;
-    std::vector<AdvisoryPkg> pkgsSecondRun;
-    Dataiterator di;
-    bool eq;
+    const AdvisoryIndex & index = dnf_sack_get_advisory_index(sack);
+    std::vector<AdvisoryIndex::Entry> pkgsSecondRun;
     auto resultPset = result.get();
 
-    // iterate over advisories
-    dataiterator_init(&di, pool, 0, 0, 0, 0, 0);
-    dataiterator_prepend_keyname(&di, UPDATE_COLLECTION);
-    while (dataiterator_step(&di)) {
-        dataiterator_setpos_parent(&di);
-        Advisory advisory(sack, di.solvid);
-
-        for (auto match_in : f.getMatches()) {
-            const char *match = match_in.str;
-            switch(keyname) {
-                case HY_PKG_ADVISORY:
-                    eq = advisory.matchName(match);
-                    break;
-                case HY_PKG_ADVISORY_BUG:
-                    eq = advisory.matchBug(match);
-                    break;
-                case HY_PKG_ADVISORY_CVE:
-                    eq = advisory.matchCVE(match);
-                    break;
-                case HY_PKG_ADVISORY_TYPE:
-                    eq = advisory.matchKind(match);
-                    break;
-                case HY_PKG_ADVISORY_SEVERITY:
-                    eq = advisory.matchSeverity(match);
-                    break;
-                default:
-                    eq = false;
-            }
-            if (eq) {
-                advisory.getPackages(pkgs, false);
+    // collect advisories matching any of the values
+    Map advisories;
+    map_init(&advisories, pool->nsolvables);
+    bool anyAdvisory = false;
+    for (auto match_in : f.getMatches()) {
+        const char *match = match_in.str;
+        const std::vector<Id> *matched;
+        switch(keyname) {
+            case HY_PKG_ADVISORY:
+                matched = &index.findByName(match);
                 break;
-            }
+            case HY_PKG_ADVISORY_BUG:
+                matched = &index.findByBug(match);
+                break;
+            case HY_PKG_ADVISORY_CVE:
+                matched = &index.findByCVE(match);
+                break;
+            case HY_PKG_ADVISORY_TYPE:
+                matched = &index.findByType(match);
+                break;
+            case HY_PKG_ADVISORY_SEVERITY:
+                matched = &index.findBySeverity(match);
+                break;
+            default:
+                matched = nullptr;
+        }
+        if (!matched)
+            continue;
+        for (auto advisory : *matched) {
+            MAPSET(&advisories, advisory);
+            anyAdvisory = true;
         }
-        dataiterator_skip_solvable(&di);
     }
-    dataiterator_free(&di);
-    std::sort(pkgs.begin(), pkgs.end(), advisoryPkgSort);
+    if (!anyAdvisory) {
+        map_free(&advisories);
+        return;
+    }
 
-    // convert nevras (from DnfAdvisoryPkg) to pool ids
+    // convert nevras of the matched advisories to pool ids
     Id id = -1;
     int cmp_type = f.getCmpType();
     bool cmpTypeGreaterOrLower = cmp_type & HY_GT || cmp_type & HY_LT;
-    while (true) {
-        if (pkgs.size() == 0)
-            break;
-        id = resultPset->next(id);
-        if (id == -1)
-            break;
+    while ((id = resultPset->next(id)) != -1) {
         Solvable* s = pool_id2solvable(pool, id);
-        auto low = std::lower_bound(pkgs.begin(), pkgs.end(), *s, advisoryPkgCompareSolvable);
-        if (low != pkgs.end() && low->nevraEQ(s)) {
+        auto range = index.find(s->name, s->arch, s->evr);
+        for (auto entry = range.first; entry != range.second; ++entry) {
+            if (!MAPTST(&advisories, entry->advisory))
+                continue;
             if (cmpTypeGreaterOrLower) {
-                pkgsSecondRun.push_back(*low);
+                pkgsSecondRun.push_back(*entry);
             } else {
                 MAPSET(m, id);
             }
+            break;
         }
     }
-    if (!cmpTypeGreaterOrLower) {
+    map_free(&advisories);
+    if (!cmpTypeGreaterOrLower || pkgsSecondRun.empty()) {
         return;
     }
-    std::sort(pkgsSecondRun.begin(), pkgsSecondRun.end(), advisoryPkgSort);
+    std::sort(pkgsSecondRun.begin(), pkgsSecondRun.end(), advisoryEntryCompareNameArch);
     id = -1;
-    while (true) {
-        if (pkgsSecondRun.size() == 0)
-            break;
-        id = resultPset->next(id);
-        if (id == -1)
-            break;
+    while ((id = resultPset->next(id)) != -1) {
         Solvable* s = pool_id2solvable(pool, id);
-        auto low = std::lower_bound(pkgsSecondRun.begin(), pkgsSecondRun.end(), *s,
-                                    advisoryPkgCompareSolvableNameArch);
-        while (low != pkgsSecondRun.end() && low->getName() == s->name &&
-            low->getArch() == s->arch) {
-
-            int cmp = pool_evrcmp(pool, s->evr, low->getEVR(), EVRCMP_COMPARE);
+        AdvisoryIndex::Entry key{s->name, s->arch, 0, 0};
+        auto low = std::lower_bound(pkgsSecondRun.begin(), pkgsSecondRun.end(), key,
+                                    advisoryEntryCompareNameArch);
+        while (low != pkgsSecondRun.end() && low->name == s->name && low->arch == s->arch) {
+            int cmp = pool_evrcmp(pool, s->evr, low->evr, EVRCMP_COMPARE);
             if ((cmp > 0 && cmp_type & HY_GT) ||
                 (cmp < 0 && cmp_type & HY_LT) ||
                 (cmp == 0 && cmp_type & HY_EQ)) {
@@ -1583,28 +1791,14 @@ Query::Impl::filterLatest(const Filter & f, Map *m)
     Pool *pool = dnf_sack_get_pool(sack);
     auto resultPset = result.get();
 
+    Queue samename;
+    queue_init(&samename);
+    orderByNameEvr(sack, resultPset, keyname == HY_PKG_LATEST_PER_ARCH, &samename);
+
     for (auto match_in : f.getMatches()) {
         int latest = match_in.num;
         if (latest == 0)
             continue;
-        Queue samename;
-
-        queue_init(&samename);
-        Id id = -1;
-        while (true) {
-            id = resultPset->next(id);
-            if (id == -1)
-                break;
-            queue_push(&samename, id);
-        }
-
-        if (keyname == HY_PKG_LATEST_PER_ARCH) {
-            solv_sort(samename.elements, samename.count, sizeof(Id),
-                      filter_latest_sortcmp_byarch, pool);
-        } else {
-            solv_sort(samename.elements, samename.count, sizeof(Id),
-                      filter_latest_sortcmp, pool);
-        }
 
         Solvable *considered, *highest = 0;
         int start_block = -1;
@@ -1628,8 +1822,8 @@ Query::Impl::filterLatest(const Filter & f, Map *m)
         if (start_block != -1) {
             add_latest_to_map(pool, m, &samename, start_block, i, latest);
         }
-        queue_free(&samename);
     }
+    queue_free(&samename);
 }
 
 void
@@ -1644,10 +1838,19 @@ Query::Impl::filterUpdown(const Filter & f, Map *m)
         return;
     }
 
+    bool downgrade = f.getKeyname() == HY_PKG_DOWNGRADES;
     for (auto match_in : f.getMatches()) {
         if (match_in.num == 0)
             continue;
 
+        // a large candidate set is walked in the evr order of the sack name by name
+        if (resultPset->size() * 32 >= static_cast<size_t>(pool->nsolvables)) {
+            forEachUpdown(sack, downgrade, resultPset->getMap(), [&](Id pkg, Id) {
+                MAPSET(m, pkg);
+            });
+            continue;
+        }
+
         Id id = -1;
         while (true) {
             id = resultPset->next(id);
@@ -1656,7 +1859,7 @@ Query::Impl::filterUpdown(const Filter & f, Map *m)
             Solvable *s = pool_id2solvable(pool, id);
             if (s->repo == pool->installed)
                 continue;
-            if (f.getKeyname() == HY_PKG_DOWNGRADES) {
+            if (downgrade) {
                 if (what_downgrades(pool, id) > 0)
                     MAPSET(m, id);
             } else if (what_upgrades(pool, id) > 0)
@@ -1668,31 +1871,22 @@ Query::Impl::filterUpdown(const Filter & f, Map *m)
 void
 Query::Impl::filterUpdownAble(const Filter  &f, Map *m)
 {
-    Id p, what;
-    Solvable *s;
     Pool *pool = dnf_sack_get_pool(sack);
 
-    dnf_sack_make_provides_ready(sack);
-
     if (!pool->installed) {
         return;
     }
     auto resultMap = result->getMap();
+    bool downgrade = f.getKeyname() == HY_PKG_DOWNGRADABLE;
 
     for (auto match_in : f.getMatches()) {
         if (match_in.num == 0)
             continue;
 
-        FOR_PKG_SOLVABLES(p) {
-            s = pool_id2solvable(pool, p);
-            if (s->repo == pool->installed)
-                continue;
-
-            what = (f.getKeyname() == HY_PKG_DOWNGRADABLE) ? what_downgrades(pool, p) :
-                what_upgrades(pool, p);
-            if (what != 0 && map_tst(resultMap, what))
-                map_set(m, what);
-        }
+        forEachUpdown(sack, downgrade, nullptr, [&](Id, Id what) {
+            if (MAPTST(resultMap, what))
+                MAPSET(m, what);
+        });
     }
 }
 
@@ -1707,6 +1901,22 @@ Query::Impl::filterDataiterator(const Filter & f, Map *m)
 
     assert(f.getMatchType() == _HY_STR);
 
+    // for a large candidate set a single pass over the whole pool is cheaper than setting up
+    // the iterator (and its matcher) again for every solvable
+    if (resultPset->size() * 2 > static_cast<size_t>(pool->nsolvables)) {
+        auto resultMap = resultPset->getMap();
+        for (auto match_in : f.getMatches()) {
+            dataiterator_init(&di, pool, 0, 0, keyname, match_in.str, flags);
+            while (dataiterator_step(&di)) {
+                if (MAPTST(resultMap, di.solvid))
+                    MAPSET(m, di.solvid);
+                dataiterator_skip_solvable(&di);
+            }
+            dataiterator_free(&di);
+        }
+        return;
+    }
+
     for (auto match_in : f.getMatches()) {
         const char *match = match_in.str;
         Id id = -1;
@@ -1738,6 +1948,94 @@ bool Query::Impl::isGlob(const std::vector<const char *> &matches) const
 void
 Query::apply() { pImpl->apply(); }
 
+void
+Query::Impl::applyFilter(const Filter & f, Map *m)
+{
+    switch (f.getKeyname()) {
+        case HY_PKG:
+            filterPkg(f, m);
+            break;
+        case HY_PKG_ALL:
+        case HY_PKG_EMPTY:
+            /* used to set query empty by keeping Map m empty */
+            break;
+        case HY_PKG_CONFLICTS:
+            filterRcoReldep(f, m);
+            break;
+        case HY_PKG_NAME:
+            filterName(f, m);
+            break;
+        case HY_PKG_EPOCH:
+            filterEpoch(f, m);
+            break;
+        case HY_PKG_EVR:
+            filterEvr(f, m);
+            break;
+        case HY_PKG_NEVRA:
+            filterNevra(f, m);
+            break;
+        case HY_PKG_VERSION:
+            filterVersion(f, m);
+            break;
+        case HY_PKG_RELEASE:
+            filterRelease(f, m);
+            break;
+        case HY_PKG_ARCH:
+            filterArch(f, m);
+            break;
+        case HY_PKG_SOURCERPM:
+            filterSourcerpm(f, m);
+            break;
+        case HY_PKG_OBSOLETES:
+            if (f.getMatchType() == _HY_RELDEP)
+                filterRcoReldep(f, m);
+            else {
+                assert(f.getMatchType() == _HY_PKG);
+                filterObsoletes(f, m);
+            }
+            break;
+        case HY_PKG_PROVIDES:
+            assert(f.getMatchType() == _HY_RELDEP);
+            filterProvidesReldep(f, m);
+            break;
+        case HY_PKG_ENHANCES:
+        case HY_PKG_RECOMMENDS:
+        case HY_PKG_REQUIRES:
+        case HY_PKG_SUGGESTS:
+        case HY_PKG_SUPPLEMENTS:
+            assert(f.getMatchType() == _HY_RELDEP);
+            filterRcoReldep(f, m);
+            break;
+        case HY_PKG_REPONAME:
+            filterReponame(f, m);
+            break;
+        case HY_PKG_LOCATION:
+            filterLocation(f, m);
+            break;
+        case HY_PKG_ADVISORY:
+        case HY_PKG_ADVISORY_BUG:
+        case HY_PKG_ADVISORY_CVE:
+        case HY_PKG_ADVISORY_SEVERITY:
+        case HY_PKG_ADVISORY_TYPE:
+            filterAdvisory(f, m, f.getKeyname());
+            break;
+        case HY_PKG_LATEST:
+        case HY_PKG_LATEST_PER_ARCH:
+            filterLatest(f, m);
+            break;
+        case HY_PKG_DOWNGRADABLE:
+        case HY_PKG_UPGRADABLE:
+            filterUpdownAble(f, m);
+            break;
+        case HY_PKG_DOWNGRADES:
+        case HY_PKG_UPGRADES:
+            filterUpdown(f, m);
+            break;
+        default:
+            filterDataiterator(f, m);
+    }
+}
+
 void
 Query::Impl::apply()
 {
@@ -1746,106 +2044,124 @@ Query::Impl::apply()
 
     Pool *pool = dnf_sack_get_pool(sack);
     Map m;
-    if (!result)
+    std::string cacheKey;
+    bool useCache = false;
+    if (!result) {
         initResult();
+        // only queries starting from all packages can be answered from the sack cache
+        useCache = dnf_sack_get_query_cache_enabled(sack) && buildCacheKey(cacheKey);
+        if (useCache) {
+            auto cached = dnf_sack_query_cache_lookup(sack, cacheKey);
+            if (cached) {
+                result.reset(new PackageSet(*cached));
+                applied = true;
+                filters.clear();
+                return;
+            }
+        }
+    }
+    // filters combine their bitmaps with the result and parallel ones read it from several
+    // threads, convert a sparse result here before any of them runs
+    Map *resultMap = result->getMap();
     map_init(&m, pool->nsolvables);
-    assert(m.size == result->getMap()->size);
-    for (auto f : filters) {
-        map_empty(&m);
-        switch (f.getKeyname()) {
-            case HY_PKG:
-                filterPkg(f, &m);
-                break;
-            case HY_PKG_ALL:
-            case HY_PKG_EMPTY:
-                /* used to set query empty by keeping Map m empty */
-                break;
-            case HY_PKG_CONFLICTS:
-                filterRcoReldep(f, &m);
-                break;
-            case HY_PKG_NAME:
-                filterName(f, &m);
-                break;
-            case HY_PKG_EPOCH:
-                filterEpoch(f, &m);
-                break;
-            case HY_PKG_EVR:
-                filterEvr(f, &m);
-                break;
-            case HY_PKG_NEVRA:
-                filterNevra(f, &m);
-                break;
-            case HY_PKG_VERSION:
-                filterVersion(f, &m);
-                break;
-            case HY_PKG_RELEASE:
-                filterRelease(f, &m);
-                break;
-            case HY_PKG_ARCH:
-                filterArch(f, &m);
-                break;
-            case HY_PKG_SOURCERPM:
-                filterSourcerpm(f, &m);
-                break;
-            case HY_PKG_OBSOLETES:
-                if (f.getMatchType() == _HY_RELDEP)
-                    filterRcoReldep(f, &m);
-                else {
-                    assert(f.getMatchType() == _HY_PKG);
-                    filterObsoletes(f, &m);
-                }
-                break;
-            case HY_PKG_PROVIDES:
-                assert(f.getMatchType() == _HY_RELDEP);
-                filterProvidesReldep(f, &m);
-                break;
-            case HY_PKG_ENHANCES:
-            case HY_PKG_RECOMMENDS:
-            case HY_PKG_REQUIRES:
-            case HY_PKG_SUGGESTS:
-            case HY_PKG_SUPPLEMENTS:
-                assert(f.getMatchType() == _HY_RELDEP);
-                filterRcoReldep(f, &m);
-                break;
-            case HY_PKG_REPONAME:
-                filterReponame(f, &m);
-                break;
-            case HY_PKG_LOCATION:
-                filterLocation(f, &m);
-                break;
-            case HY_PKG_ADVISORY:
-            case HY_PKG_ADVISORY_BUG:
-            case HY_PKG_ADVISORY_CVE:
-            case HY_PKG_ADVISORY_SEVERITY:
-            case HY_PKG_ADVISORY_TYPE:
-                filterAdvisory(f, &m, f.getKeyname());
-                break;
-            case HY_PKG_LATEST:
-            case HY_PKG_LATEST_PER_ARCH:
-                filterLatest(f, &m);
-                break;
-            case HY_PKG_DOWNGRADABLE:
-            case HY_PKG_UPGRADABLE:
-                filterUpdownAble(f, &m);
-                break;
-            case HY_PKG_DOWNGRADES:
-            case HY_PKG_UPGRADES:
-                filterUpdown(f, &m);
-                break;
-            default:
-                filterDataiterator(f, &m);
+    assert(m.size == resultMap->size);
+
+    // Filters only remove packages, so the ones that test each package on its own can run in any
+    // order. Run the cheap ones first within each run of such filters, order dependent filters
+    // stay where they were added.
+    std::vector<const Filter *> plan;
+    plan.reserve(filters.size());
+    for (auto & f : filters)
+        plan.push_back(&f);
+    auto segmentStart = plan.begin();
+    for (auto it = plan.begin(); it != plan.end(); ++it) {
+        if (filterIsOrderDependent(**it)) {
+            std::stable_sort(segmentStart, it, [](const Filter * a, const Filter * b) {
+                return filterCost(*a) < filterCost(*b);
+            });
+            segmentStart = it + 1;
+        }
+    }
+    std::stable_sort(segmentStart, plan.end(), [](const Filter * a, const Filter * b) {
+        return filterCost(*a) < filterCost(*b);
+    });
+
+    const bool measure = profiling || traceCallback;
+    for (auto f : plan) {
+        std::chrono::steady_clock::time_point start;
+        size_t countBefore = 0;
+        if (measure) {
+            countBefore = result->size();
+            start = std::chrono::steady_clock::now();
         }
-        if (f.getCmpType() & HY_NOT)
-            map_subtract(result->getMap(), &m);
+        map_empty(&m);
+        indexUsed = false;
+        applyFilter(*f, &m);
+        if (f->getCmpType() & HY_NOT)
+            bitmapSubtract(resultMap, &m);
         else
-            map_and(result->getMap(), &m);
+            bitmapAnd(resultMap, &m);
+        if (measure) {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            size_t countAfter = result->size();
+            if (profiling)
+                profile.push_back({f->getKeyname(), f->getCmpType(), elapsed.count(),
+                                   countBefore, countAfter, indexUsed});
+            if (traceCallback)
+                traceCallback(*f, countBefore, countAfter, elapsed.count());
+        }
+        // nothing can be added back by the remaining filters
+        if (bitmapEmpty(resultMap))
+            break;
     }
     map_free(&m);
+    if (useCache)
+        dnf_sack_query_cache_store(sack, cacheKey, *result);
 
     applied = true;
     filters.clear();
 }
 
+/**
+* @brief Serializes flags and filters of the query. Returns false for queries that can not be
+* cached, that is when a filter matches a package set.
+*/
+bool
+Query::Impl::buildCacheKey(std::string & key) const
+{
+    key = std::to_string(flags);
+    for (auto & f : filters) {
+        if (f.getMatchType() == _HY_PKG)
+            return false;
+        key += '|';
+        key += std::to_string(f.getKeyname());
+        key += ',';
+        key += std::to_string(f.getCmpType());
+        key += ',';
+        key += std::to_string(f.getMatchType());
+        for (auto & match : f.getMatches()) {
+            key += ',';
+            switch (f.getMatchType()) {
+                case _HY_NUM:
+                    key += std::to_string(match.num);
+                    break;
+                case _HY_RELDEP:
+                    key += std::to_string(match.reldep);
+                    break;
+                case _HY_STR:
+                    // length prefix keeps strings containing separators unambiguous
+                    key += std::to_string(strlen(match.str));
+                    key += ':';
+                    key += match.str;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    return true;
+}
+
 GPtrArray *
 Query::run()
 {
@@ -1867,12 +2183,26 @@ Query::getIndexItem(int index)
     return (*pImpl->result.get())[index];
 }
 
+Query::iterator
+Query::begin()
+{
+    apply();
+    return iterator(pImpl->sack, pImpl->result->begin());
+}
+
+Query::iterator
+Query::end()
+{
+    apply();
+    return iterator(pImpl->sack, pImpl->result->end());
+}
+
 void
 Query::queryUnion(Query & other)
 {
     apply();
     other.apply();
-    map_or(pImpl->result->getMap(), other.getResult());
+    bitmapOr(pImpl->result->getMap(), other.getResult());
 }
 
 void
@@ -1880,7 +2210,7 @@ Query::queryIntersection(Query & other)
 {
     apply();
     other.apply();
-    map_and(pImpl->result->getMap(), other.getResult());
+    bitmapAnd(pImpl->result->getMap(), other.getResult());
 }
 
 void
@@ -1888,7 +2218,7 @@ Query::queryDifference(Query & other)
 {
     apply();
     other.apply();
-    map_subtract(pImpl->result->getMap(), other.getResult());
+    bitmapSubtract(pImpl->result->getMap(), other.getResult());
 }
 
 bool
@@ -2047,7 +2377,7 @@ Query::filterUnneeded(const libdnf::Swdb &swdb, bool debug_solver)
     for (int i = 0; i < que.size(); ++i) {
         MAPSET(&result, que[i]);
     }
-    map_and(getResult(), &result);
+    bitmapAnd(getResult(), &result);
     map_free(&result);
     return 0;
 }
@@ -2095,6 +2425,24 @@ Query::getAdvisoryPkgs(int cmpType, std::vector<AdvisoryPkg> & advisoryPkgs)
     }
 }
 
+void
+Query::getPackageAdvisories(int cmpType, std::vector<std::pair<Id, Id>> & pkgAdvisories)
+{
+    apply();
+    Pool *pool = dnf_sack_get_pool(pImpl->sack);
+    const AdvisoryIndex & index = dnf_sack_get_advisory_index(pImpl->sack);
+    std::vector<Id> advisories;
+    auto resultPset = pImpl->result.get();
+
+    Id id = -1;
+    while ((id = resultPset->next(id)) != -1) {
+        advisories.clear();
+        index.getAdvisories(pool, id, cmpType, advisories);
+        for (auto advisory : advisories)
+            pkgAdvisories.emplace_back(id, advisory);
+    }
+}
+
 void
 Query::filterUserInstalled(const libdnf::Swdb &swdb)
 {
@@ -2108,29 +2456,15 @@ void
 hy_query_to_name_ordered_queue(HyQuery query, libdnf::IdQueue * samename)
 {
     hy_query_apply(query);
-    Pool *pool = dnf_sack_get_pool(query->getSack());
-
-    const auto result = query->getResult();
-    for (int i = 1; i < pool->nsolvables; ++i)
-        if (MAPTST(result, i))
-            samename->pushBack(i);
-
-    solv_sort(samename->data(), samename->size(), sizeof(Id), libdnf::filter_latest_sortcmp,
-        pool);
+    libdnf::orderByNameEvr(query->getSack(), query->getResultPset(), false,
+                           samename->getQueue());
 }
 
 void
 hy_query_to_name_arch_ordered_queue(HyQuery query, libdnf::IdQueue * samename)
 {
     hy_query_apply(query);
-    Pool *pool = dnf_sack_get_pool(query->getSack());
-
-    const auto result = query->getResult();
-    for (int i = 1; i < pool->nsolvables; ++i)
-        if (MAPTST(result, i))
-            samename->pushBack(i);
-
-    solv_sort(samename->data(), samename->size(), sizeof(Id),
-        libdnf::filter_latest_sortcmp_byarch, pool);
+    libdnf::orderByNameEvr(query->getSack(), query->getResultPset(), true,
+                           samename->getQueue());
 }
 
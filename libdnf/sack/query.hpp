@@ -21,7 +21,9 @@
 #ifndef __QUERY_HPP
 #define __QUERY_HPP
 
+#include <functional>
 #include <memory>
+#include <utility>
 #include <vector>
 #include "../hy-types.h"
 #include "../repo/solvable/Dependency.hpp"
@@ -29,6 +31,8 @@
 #include "../transaction/Swdb.hpp"
 #include "../dnf-types.h"
 #include "advisorypkg.hpp"
+#include "packagehandle.hpp"
+#include "packageset.hpp"
 
 namespace libdnf {
 
@@ -59,6 +63,26 @@ private:
     std::shared_ptr<Impl> pImpl;
 };
 
+/**
+* @brief Called by Query::apply() after each executed filter with the number of packages in the
+* query before and after the filter and the time spent in the filter in seconds.
+*/
+typedef std::function<void(const Filter & filter, size_t countBefore, size_t countAfter,
+                           double seconds)> QueryTraceCallback;
+
+/**
+* @brief Record about one filter executed by Query::apply(), see Query::setProfiling()
+*/
+struct QueryFilterProfile {
+    int keyname;
+    int cmpType;
+    double seconds;
+    size_t countBefore;
+    size_t countAfter;
+    /** the filter was answered from a sack index instead of testing every package */
+    bool indexUsed;
+};
+
 /**
 * @brief Provides package filtering
 * addFilter() can return DNF_ERROR_BAD_QUERY in case if cmp_type or keyname is incompatible with provided data type
@@ -112,6 +136,47 @@ public:
     int addFilter(HyNevra nevra, bool icase);
     void apply();
 
+    /**
+    * @brief Set a callback tracing the filters executed by apply(). The filters are reported in
+    * the order they were executed which can differ from the order they were added in, cheaper
+    * filters run first and the remaining filters are skipped once the query is empty.
+    *
+    * @param callback p_callback: Empty function disables tracing
+    */
+    void setTraceCallback(QueryTraceCallback callback);
+
+    /**
+    * @brief Enable or disable recording of QueryFilterProfile for each filter executed by apply().
+    * Records are kept until clear() or until profiling is disabled.
+    *
+    * @param enabled p_enabled: Whether to record the profile
+    */
+    void setProfiling(bool enabled);
+    bool getProfiling() const noexcept;
+
+    /**
+    * @brief Return records of the filters executed while profiling was enabled, in order of execution
+    *
+    * @return const std::vector< libdnf::QueryFilterProfile >&
+    */
+    const std::vector<QueryFilterProfile> & getProfile() const noexcept;
+
+    /**
+    * @brief Enable evaluation of some filters on a thread pool. Each thread tests a range of
+    * solvable ids that is a multiple of 64, so the threads set bits in distinct words of the
+    * result. Only filters that read pool strings and dependency arrays of solvables run in
+    * parallel: name with HY_GLOB, HY_SUBSTR or HY_ICASE, and requires, recommends, suggests,
+    * supplements, enhances, conflicts and obsoletes given by reldeps (obsoletes given by a
+    * package set stay serial). Filters using Dataiterator (file, description, summary, url, ...)
+    * stay serial, because libsolv pages repodata in and uses the shared pool scratch space during
+    * lookups, so Dataiterator is not safe to use from several threads.
+    *
+    * @param threads p_threads: Number of threads, 0 or 1 disables parallel evaluation
+    * @param minPackages p_minPackages: Run filters in parallel only if the query holds at least
+    * that many packages
+    */
+    void setParallel(unsigned int threads, size_t minPackages = 10000);
+
     /**
     * @brief Applies Query and returns DnfPackages in GPtrArray
     *
@@ -127,6 +192,44 @@ public:
     const DnfPackageSet * runSet();
     Id getIndexItem(int index);
 
+    /**
+    * @brief Forward iterator over handles of packages in the query result. Handles are made on
+    * demand, the cost is proportional to the number of packages consumed. Any change of
+    * the query invalidates the iterator.
+    */
+    class iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef PackageHandle value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const PackageHandle * pointer;
+        typedef PackageHandle reference;
+
+        iterator(DnfSack *sack, PackageSet::const_iterator position) noexcept
+        : sack(sack), position(position) {}
+        PackageHandle operator *() const noexcept { return PackageHandle(sack, *position); }
+        iterator & operator ++() { ++position; return *this; }
+        iterator operator ++(int) { auto ret = *this; ++position; return ret; }
+        bool operator ==(const iterator & other) const noexcept
+        {
+            return position == other.position;
+        }
+        bool operator !=(const iterator & other) const noexcept
+        {
+            return position != other.position;
+        }
+
+    private:
+        DnfSack *sack;
+        PackageSet::const_iterator position;
+    };
+
+    /**
+    * @brief Applies Query and returns iterator to the first package of the result
+    */
+    iterator begin();
+    iterator end();
+
     /**
     * @brief Applies both queries and result of the other query is added to result of this query
     *
@@ -159,6 +262,16 @@ public:
     void filterDuplicated();
     int filterUnneeded(const libdnf::Swdb &swdb, bool debug_solver);
     void getAdvisoryPkgs(int cmpType,  std::vector<AdvisoryPkg> & advisoryPkgs);
+
+    /**
+    * @brief Applies Query and returns advisories of all packages in the result at once. Same as
+    * dnf_package_get_advisories() called for each package, but the advisory index is looked up
+    * only once.
+    *
+    * @param cmpType p_cmpType: HY_EQ, HY_GT, HY_LT or their combination
+    * @param pkgAdvisories p_pkgAdvisories: Pairs of package and advisory ids sorted by package id
+    */
+    void getPackageAdvisories(int cmpType, std::vector<std::pair<Id, Id>> & pkgAdvisories);
     void filterUserInstalled(const libdnf::Swdb &swdb);
 private:
     class Impl;
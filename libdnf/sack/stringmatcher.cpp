@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <ctype.h>
+#include <fnmatch.h>
+#include <string.h>
+
+#include "stringmatcher.hpp"
+#include "../hy-types.h"
+
+namespace libdnf {
+
+static bool
+hasGlobChars(const char *str, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        if (str[i] == '*' || str[i] == '?' || str[i] == '[' || str[i] == '\\')
+            return true;
+    }
+    return false;
+}
+
+static void
+toLower(std::string & str)
+{
+    for (auto & c : str)
+        c = tolower(static_cast<unsigned char>(c));
+}
+
+StringMatcher::StringMatcher(const char *pattern, int cmpType)
+: kind(Kind::EXACT), icase(cmpType & HY_ICASE), needle(pattern)
+{
+    if (cmpType & HY_GLOB) {
+        // leading and trailing stars around a literal turn the glob into a plain compare
+        const char *begin = pattern;
+        const char *end = pattern + strlen(pattern);
+        bool leading = false;
+        bool trailing = false;
+        while (begin < end && *begin == '*') {
+            ++begin;
+            leading = true;
+        }
+        while (end > begin && end[-1] == '*') {
+            --end;
+            trailing = true;
+        }
+        if (hasGlobChars(begin, end - begin)) {
+            kind = Kind::GLOB;
+            return;
+        }
+        needle.assign(begin, end);
+        if (leading && trailing)
+            kind = Kind::SUBSTR;
+        else if (leading)
+            kind = Kind::SUFFIX;
+        else if (trailing)
+            kind = Kind::PREFIX;
+    } else if (cmpType & HY_SUBSTR) {
+        kind = Kind::SUBSTR;
+    }
+    if (icase)
+        toLower(needle);
+}
+
+bool
+StringMatcher::matchImpl(const char *str, bool nocase) const
+{
+    const char *n = needle.c_str();
+    switch (kind) {
+        case Kind::EXACT:
+            return (nocase ? strcasecmp(str, n) : strcmp(str, n)) == 0;
+        case Kind::PREFIX:
+            return (nocase ? strncasecmp(str, n, needle.size()) :
+                             strncmp(str, n, needle.size())) == 0;
+        case Kind::SUFFIX: {
+            size_t len = strlen(str);
+            if (len < needle.size())
+                return false;
+            str += len - needle.size();
+            return (nocase ? strcasecmp(str, n) : strcmp(str, n)) == 0;
+        }
+        case Kind::SUBSTR:
+            return (nocase ? strcasestr(str, n) : strstr(str, n)) != NULL;
+        case Kind::GLOB:
+            return fnmatch(n, str, icase ? FNM_CASEFOLD : 0) == 0;
+    }
+    return false;
+}
+
+bool
+StringMatcher::match(const char *str) const
+{
+    return matchImpl(str, icase);
+}
+
+bool
+StringMatcher::matchLowered(const char *lowered) const
+{
+    return matchImpl(lowered, false);
+}
+
+StringIdCache::StringIdCache(Pool *pool)
+{
+    map_init(&tested, pool->ss.nstrings);
+    map_init(&matched, pool->ss.nstrings);
+}
+
+StringIdCache::~StringIdCache()
+{
+    map_free(&tested);
+    map_free(&matched);
+}
+
+PoolStringMatcher::PoolStringMatcher(Pool *pool, int cmpType)
+: pool(pool), cmpType(cmpType), cache(pool)
+{}
+
+void
+PoolStringMatcher::addPattern(const char *pattern)
+{
+    matchers.emplace_back(pattern, cmpType);
+}
+
+bool
+PoolStringMatcher::matchString(const char *str)
+{
+    if (!str)
+        return false;
+    if (!(cmpType & HY_ICASE)) {
+        for (auto & matcher : matchers) {
+            if (matcher.match(str))
+                return true;
+        }
+        return false;
+    }
+    // fold the case of the string once for all the patterns
+    lowered.assign(str);
+    toLower(lowered);
+    for (auto & matcher : matchers) {
+        if (matcher.matchLowered(lowered.c_str()))
+            return true;
+    }
+    return false;
+}
+
+}
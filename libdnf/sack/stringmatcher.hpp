@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __STRING_MATCHER_HPP
+#define __STRING_MATCHER_HPP
+
+#include <string>
+#include <vector>
+
+#include <solv/bitmap.h>
+#include <solv/pool.h>
+
+namespace libdnf {
+
+/**
+* @brief Pattern of a string filter prepared for matching many strings. cmpType is HY_EQ,
+* HY_SUBSTR or HY_GLOB, optionally with HY_ICASE. Globs of the form "abc", "abc*", "*abc" and
+* "*abc*" are matched by plain string compares, other globs are passed to fnmatch().
+*/
+class StringMatcher {
+public:
+    StringMatcher(const char *pattern, int cmpType);
+
+    bool match(const char *str) const;
+
+    /**
+    * @brief Same as match() for a string already converted to lower case, avoids case folding
+    * of the string for every pattern.
+    */
+    bool matchLowered(const char *lowered) const;
+
+    bool isIcase() const noexcept { return icase; }
+
+private:
+    enum class Kind { EXACT, PREFIX, SUFFIX, SUBSTR, GLOB };
+
+    bool matchImpl(const char *str, bool nocase) const;
+
+    Kind kind;
+    bool icase;
+    std::string needle;
+};
+
+/**
+* @brief Boolean result of a predicate remembered per pool string Id. Packages share name, arch
+* and evr Ids a lot, so filters evaluate their predicate once per distinct Id. Not thread safe,
+* use one instance per thread.
+*/
+class StringIdCache {
+public:
+    explicit StringIdCache(Pool *pool);
+    ~StringIdCache();
+    StringIdCache(const StringIdCache &) = delete;
+    StringIdCache & operator=(const StringIdCache &) = delete;
+
+    /**
+    * @brief Returns predicate(strId), calls the predicate only the first time strId is seen
+    */
+    template<typename Predicate>
+    bool get(Id strId, Predicate predicate);
+
+private:
+    Map tested;
+    Map matched;
+};
+
+template<typename Predicate>
+bool
+StringIdCache::get(Id strId, Predicate predicate)
+{
+    if (strId < 0 || strId >= (tested.size << 3))
+        return predicate(strId);
+    if (MAPTST(&tested, strId))
+        return MAPTST(&matched, strId);
+    MAPSET(&tested, strId);
+    if (!predicate(strId))
+        return false;
+    MAPSET(&matched, strId);
+    return true;
+}
+
+/**
+* @brief Matches pool strings against any of a set of patterns. The result is remembered per
+* string Id, so each distinct string is evaluated only once however many solvables share it.
+* Not thread safe, use one instance per thread.
+*/
+class PoolStringMatcher {
+public:
+    PoolStringMatcher(Pool *pool, int cmpType);
+
+    void addPattern(const char *pattern);
+
+    /**
+    * @brief Returns true if the pool string strId matches any of the patterns
+    */
+    bool match(Id strId);
+
+    /**
+    * @brief Same as match(Id) for a string derived from the pool string strId, e.g. the version
+    * part of an evr. getString(strId) is called only when strId is seen for the first time.
+    */
+    template<typename GetString>
+    bool match(Id strId, GetString getString);
+
+    /**
+    * @brief Matches a string that is not in the pool, the result is not remembered
+    */
+    bool matchString(const char *str);
+
+private:
+    Pool *pool;
+    int cmpType;
+    std::vector<StringMatcher> matchers;
+    StringIdCache cache;
+    std::string lowered;
+};
+
+inline bool
+PoolStringMatcher::match(Id strId)
+{
+    return match(strId, [this](Id id) { return pool_id2str(pool, id); });
+}
+
+template<typename GetString>
+bool
+PoolStringMatcher::match(Id strId, GetString getString)
+{
+    return cache.get(strId, [&](Id id) { return matchString(getString(id)); });
+}
+
+}
+
+#endif /* __STRING_MATCHER_HPP */
@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <map>
 #include <sstream>
+#include <tuple>
 
 #include "../hy-subject.h"
 #include "../nevra.hpp"
@@ -202,6 +203,120 @@ RPMItem::dbSelectOrInsert()
     }
 }
 
+void
+RPMItem::saveNew(SQLite3Ptr conn, const std::vector< RPMItemPtr > &items)
+{
+    // 6 bound values per rpm row, stay below the default SQLITE_MAX_VARIABLE_NUMBER (999)
+    constexpr std::size_t ROWS_PER_INSERT = 166;
+
+    // full chunks share one statement per table and the rest goes through dbInsert(), so the
+    // statement cache holds the same statements whatever the number of items is
+    static const std::string itemChunkSql = []() {
+        std::string sql = "INSERT INTO item VALUES (null, ?)";
+        for (std::size_t i = 1; i < ROWS_PER_INSERT; ++i) {
+            sql += ", (null, ?)";
+        }
+        return sql;
+    }();
+    static const std::string rpmChunkSql = []() {
+        std::string sql = "INSERT INTO rpm VALUES (?, ?, ?, ?, ?, ?)";
+        for (std::size_t i = 1; i < ROWS_PER_INSERT; ++i) {
+            sql += ", (?, ?, ?, ?, ?, ?)";
+        }
+        return sql;
+    }();
+
+    typedef std::tuple< std::string, int32_t, std::string, std::string, std::string > NevraKey;
+    std::map< NevraKey, std::vector< RPMItemPtr > > unsaved;
+    for (auto &rpm : items) {
+        if (rpm->getId() == 0) {
+            unsaved[NevraKey(rpm->getName(),
+                             rpm->getEpoch(),
+                             rpm->getVersion(),
+                             rpm->getRelease(),
+                             rpm->getArch())].push_back(rpm);
+        }
+    }
+    if (unsaved.empty()) {
+        return;
+    }
+
+    // ids of the inserted rows have to be read from the database, keep other writers out
+    SQLite3::TransactionGuard guard(*conn);
+
+    // a single pass over the recorded RPMs instead of a lookup per item
+    const char *sql = R"**(
+        SELECT
+            item_id,
+            name,
+            epoch,
+            version,
+            release,
+            arch
+        FROM
+            rpm
+    )**";
+    SQLite3::Query query(*conn, sql);
+    while (query.step() == SQLite3::Statement::StepResult::ROW) {
+        auto it = unsaved.find(NevraKey(query.get< std::string >("name"),
+                                        query.get< int >("epoch"),
+                                        query.get< std::string >("version"),
+                                        query.get< std::string >("release"),
+                                        query.get< std::string >("arch")));
+        if (it == unsaved.end()) {
+            continue;
+        }
+        auto id = query.get< int64_t >("item_id");
+        for (auto &rpm : it->second) {
+            rpm->setId(id);
+        }
+        unsaved.erase(it);
+    }
+
+    // one row per NEVRA, the duplicates get the id of the first RPM
+    std::vector< std::vector< RPMItemPtr > * > groups;
+    for (auto &it : unsaved) {
+        groups.push_back(&it.second);
+    }
+
+    std::size_t begin = 0;
+    for (; groups.size() - begin >= ROWS_PER_INSERT; begin += ROWS_PER_INSERT) {
+        SQLite3::Statement itemQuery(*conn, itemChunkSql);
+        for (std::size_t i = 0; i < ROWS_PER_INSERT; ++i) {
+            // the item type Item::dbInsert() writes
+            itemQuery.bind(static_cast< int >(i + 1),
+                           static_cast< int >(groups[begin + i]->front()->Item::getItemType()));
+        }
+        itemQuery.step();
+
+        // rows of a multi-row INSERT get consecutive ids in the order of the VALUES list
+        auto id = conn->lastInsertRowID() - static_cast< int64_t >(ROWS_PER_INSERT);
+        SQLite3::Statement rpmQuery(*conn, rpmChunkSql);
+        int idx = 1;
+        for (std::size_t i = begin; i < begin + ROWS_PER_INSERT; ++i) {
+            auto &rpm = groups[i]->front();
+            rpm->setId(++id);
+            rpmQuery.bind(idx++, rpm->getId());
+            rpmQuery.bind(idx++, rpm->getName());
+            rpmQuery.bind(idx++, rpm->getEpoch());
+            rpmQuery.bind(idx++, rpm->getVersion());
+            rpmQuery.bind(idx++, rpm->getRelease());
+            rpmQuery.bind(idx++, rpm->getArch());
+        }
+        rpmQuery.step();
+    }
+    for (std::size_t i = begin; i < groups.size(); ++i) {
+        groups[i]->front()->dbInsert();
+    }
+
+    for (auto group : groups) {
+        for (auto &rpm : *group) {
+            rpm->setId(group->front()->getId());
+        }
+    }
+    guard.commit();
+}
+
 TransactionItemPtr
 RPMItem::getTransactionItem(SQLite3Ptr conn, const std::string &nevra)
 {
@@ -332,6 +447,49 @@ RPMItem::resolveTransactionItemReason(SQLite3Ptr conn,
     return TransactionItemReason::UNKNOWN;
 }
 
+std::map< std::pair< std::string, std::string >, TransactionItemReason >
+RPMItem::resolveTransactionItemReasons(SQLite3Ptr conn)
+{
+    const char *sql = R"**(
+        SELECT
+            i.name as name,
+            i.arch as arch,
+            ti.action as action,
+            ti.reason as reason
+        FROM
+            trans_item ti
+        JOIN
+            trans t ON ti.trans_id = t.id
+        JOIN
+            rpm i USING (item_id)
+        WHERE
+            t.state = 1
+            /* see comment in TransactionItem.hpp - TransactionItemAction */
+            AND ti.action not in (3, 5, 7, 10)
+        ORDER BY
+            ti.trans_id DESC
+    )**";
+
+    std::map< std::pair< std::string, std::string >, TransactionItemReason > result;
+
+    SQLite3::Query query(*conn, sql);
+    while (query.step() == SQLite3::Statement::StepResult::ROW) {
+        auto key = std::make_pair(query.get< std::string >("name"), query.get< std::string >("arch"));
+        // rows are ordered from the latest transaction, only the first one counts
+        if (result.find(key) != result.end()) {
+            continue;
+        }
+        auto action = static_cast< TransactionItemAction >(query.get< int64_t >("action"));
+        if (action == TransactionItemAction::REMOVE) {
+            result.emplace(std::move(key), TransactionItemReason::UNKNOWN);
+            continue;
+        }
+        auto reason = static_cast< TransactionItemReason >(query.get< int64_t >("reason"));
+        result.emplace(std::move(key), reason);
+    }
+    return result;
+}
+
 /**
  * Compare RPM packages
  * This method doesn't care about compare package names
@@ -21,7 +21,9 @@
 #ifndef LIBDNF_TRANSACTION_RPMITEM_HPP
 #define LIBDNF_TRANSACTION_RPMITEM_HPP
 
+#include <map>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace libdnf {
@@ -61,6 +63,12 @@ public:
     ItemType getItemType() const noexcept override { return itemType; }
     void save() override;
 
+    /**
+     * Save RPMs which weren't saved yet. RPMs already recorded in the database get the ids
+     * of their rows, the others are inserted with multi-row INSERTs.
+     */
+    static void saveNew(SQLite3Ptr conn, const std::vector< RPMItemPtr > &items);
+
     static TransactionItemPtr getTransactionItem(SQLite3Ptr conn, const std::string &nevra);
     static std::vector< int64_t > searchTransactions(SQLite3Ptr conn, const std::vector< std::string > &patterns);
     static std::vector< TransactionItemPtr > getTransactionItems(SQLite3Ptr conn,
@@ -70,6 +78,14 @@ public:
                                                               const std::string &arch,
                                                               int64_t maxTransactionId);
 
+    /**
+     * Resolve reasons of all RPMs recorded in the database in a single query.
+     * \return map of (name, arch) to the reason of the latest transaction item;
+     *         UNKNOWN if the latest action was a removal
+     */
+    static std::map< std::pair< std::string, std::string >, TransactionItemReason >
+    resolveTransactionItemReasons(SQLite3Ptr conn);
+
     bool operator<(const RPMItem &other) const;
 
 protected:
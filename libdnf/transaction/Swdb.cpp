@@ -80,6 +80,9 @@ Swdb::initTransaction()
     if (transactionInProgress) {
         throw std::logic_error(_("In progress"));
     }
+    if (conn->getMode() == SQLite3::Mode::READ_ONLY) {
+        throw std::logic_error(_("History database is opened read-only"));
+    }
     transactionInProgress = std::unique_ptr< swdb_private::Transaction >(
         new swdb_private::Transaction(conn));
     itemsInProgress.clear();
@@ -485,11 +488,16 @@ Swdb::createCompsGroupItem()
 }
 
 Swdb::Swdb(const std::string &path)
+  : Swdb(path, SQLite3::Mode::EXCLUSIVE)
+{
+}
+
+Swdb::Swdb(const std::string &path, SQLite3::Mode mode)
   : conn(nullptr)
   , autoClose(true)
 {
     // check if DB file is present
-    if (!pathExists(path.c_str())) {
+    if (mode != SQLite3::Mode::READ_ONLY && !pathExists(path.c_str())) {
         // file not present
 
         // extract persistdir from path - "/var/lib/dnf/"
@@ -497,11 +505,8 @@ Swdb::Swdb(const std::string &path)
 
         Transformer transformer(path.substr(0, found), path);
         transformer.transform();
-
-        conn = std::make_shared< SQLite3 >(path);
-    } else {
-        conn = std::make_shared< SQLite3 >(path);
     }
+    conn = std::make_shared< SQLite3 >(path, mode);
 }
 
 /**
@@ -514,6 +519,9 @@ Swdb::filterUserinstalled(libdnf::PackageSet & installed) const
 {
     Pool * pool = dnf_sack_get_pool(installed.getSack());
 
+    // resolve reasons of all packages at once instead of querying the database per package
+    auto reasons = RPMItem::resolveTransactionItemReasons(conn);
+
     // iterate over solvables
     Id id = -1;
     while ((id = installed.next(id)) != -1) {
@@ -522,7 +530,11 @@ Swdb::filterUserinstalled(libdnf::PackageSet & installed) const
         const char *name = pool_id2str(pool, s->name);
         const char *arch = pool_id2str(pool, s->arch);
 
-        auto reason = RPMItem::resolveTransactionItemReason(conn, name, arch, -1);
+        auto it = reasons.find(std::make_pair(std::string(name), std::string(arch)));
+        if (it == reasons.end()) {
+            continue;
+        }
+        auto reason = it->second;
         // if not dep or weak, than consider it user installed
         if (reason == TransactionItemReason::DEPENDENCY ||
             reason == TransactionItemReason::WEAK_DEPENDENCY) {
@@ -48,6 +48,13 @@ class Swdb {
 public:
     explicit Swdb(SQLite3Ptr conn);
     explicit Swdb(const std::string &path);
+
+    /**
+    * @brief Opens the history database in given mode. The database is created or migrated from
+    * the yum history database if it doesn't exist, unless the mode is READ_ONLY. Query-only
+    * consumers should use READ_ONLY, they aren't blocked then by a writer using SHARED mode.
+    */
+    Swdb(const std::string &path, SQLite3::Mode mode);
     ~Swdb();
 
     SQLite3Ptr getConn() { return conn; }
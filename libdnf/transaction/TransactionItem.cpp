@@ -18,6 +18,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <algorithm>
+
 #include "../utils/bgettext/bgettext-lib.h"
 
 #include "TransactionItem.hpp"
@@ -144,6 +146,82 @@ TransactionItem::dbInsert()
     setId(conn->lastInsertRowID());
 }
 
+void
+TransactionItem::saveNew(SQLite3Ptr conn, const std::vector< TransactionItemPtr > &items)
+{
+    // 6 bound values per row, stay below the default SQLITE_MAX_VARIABLE_NUMBER (999)
+    constexpr std::size_t ROWS_PER_INSERT = 166;
+
+    const char *rowSql = R"**(
+        INSERT INTO
+          trans_item (
+            id,
+            trans_id,
+            item_id,
+            repo_id,
+            action,
+            reason,
+            state
+          )
+        VALUES
+          (null, ?, ?, ?, ?, ?, ?)
+    )**";
+    // full chunks share one statement and the rest is inserted row by row, so the statement
+    // cache holds two statements whatever the number of items is
+    static const std::string chunkSql = [rowSql]() {
+        std::string sql = rowSql;
+        for (std::size_t i = 1; i < ROWS_PER_INSERT; ++i) {
+            sql += ", (null, ?, ?, ?, ?, ?, ?)";
+        }
+        return sql;
+    }();
+
+    auto bindRow = [&conn](SQLite3::Statement &query, int &idx, const TransactionItemPtr &transItem) {
+        if (transItem->trans == nullptr) {
+            throw std::runtime_error(
+                _("Attempt to insert transaction item into completed transaction"));
+        }
+        query.bind(idx++, transItem->trans->getId());
+        query.bind(idx++, transItem->getItem()->getId());
+        query.bind(idx++, swdb_private::Repo::getCached(conn, transItem->getRepoid())->getId());
+        query.bind(idx++, static_cast< int >(transItem->getAction()));
+        query.bind(idx++, static_cast< int >(transItem->getReason()));
+        query.bind(idx++, static_cast< int >(transItem->getState()));
+    };
+
+    // ids of the inserted rows have to be read from the database, keep other writers out
+    SQLite3::TransactionGuard guard(*conn);
+    std::size_t begin = 0;
+    for (; items.size() - begin >= ROWS_PER_INSERT; begin += ROWS_PER_INSERT) {
+        SQLite3::Statement query(*conn, chunkSql);
+        int idx = 1;
+        for (std::size_t i = begin; i < begin + ROWS_PER_INSERT; ++i) {
+            bindRow(query, idx, items[i]);
+        }
+        query.step();
+
+        // rows of a multi-row INSERT get consecutive ids in the order of the VALUES list
+        auto id = conn->lastInsertRowID() - static_cast< int64_t >(ROWS_PER_INSERT);
+        for (std::size_t i = begin; i < begin + ROWS_PER_INSERT; ++i) {
+            items[i]->setId(++id);
+        }
+    }
+    if (begin < items.size()) {
+        SQLite3::Statement query(*conn, rowSql);
+        for (std::size_t i = begin; i < items.size(); ++i) {
+            if (i != begin) {
+                // reset the prepared statement, so it can be executed again
+                query.reset();
+            }
+            int idx = 1;
+            bindRow(query, idx, items[i]);
+            query.step();
+            items[i]->setId(conn->lastInsertRowID());
+        }
+    }
+    guard.commit();
+}
+
 void
 TransactionItem::saveReplacedBy()
 {
@@ -102,6 +102,12 @@ public:
     void saveReplacedBy();
     void saveState();
 
+    /**
+     * Insert transaction items which weren't saved yet with multi-row INSERTs.
+     * The items must belong to the same transaction and their items must have been saved.
+     */
+    static void saveNew(SQLite3Ptr conn, const std::vector< TransactionItemPtr > &items);
+
     std::size_t getHash() { return reinterpret_cast< std::size_t >(this); }
     bool operator==(TransactionItem & other) { return (other.getHash() == getHash()); }
     bool operator==(TransactionItemPtr other) { return (other->getHash() == getHash()); }
@@ -40,17 +40,22 @@ swdb_private::Transaction::begin()
     if (id != 0) {
         throw std::runtime_error(_("Transaction has already began!"));
     }
+    // the transaction with all its items is written to the disk at once
+    SQLite3::TransactionGuard guard(*conn);
     dbInsert();
     saveItems();
+    guard.commit();
 }
 
 void
 swdb_private::Transaction::finish(TransactionState state)
 {
     // save states to the database before checking for UNKNOWN state
+    SQLite3::TransactionGuard guard(*conn);
     for (auto i : getItems()) {
         i->saveState();
     }
+    guard.commit();
 
     for (auto i : getItems()) {
         if (i->getState() == TransactionItemState::UNKNOWN) {
@@ -169,9 +174,17 @@ void
 swdb_private::Transaction::saveItems()
 {
     // TODO: remove all existing items from the database first?
+    SQLite3::TransactionGuard guard(*conn);
+    std::vector< TransactionItemPtr > newItems;
     for (auto i : items) {
-        i->save();
+        if (i->getId() == 0) {
+            i->getItem()->save();
+            newItems.push_back(i);
+        } else {
+            i->save();
+        }
     }
+    TransactionItem::saveNew(conn, newItems);
 
     /* this has to be done in a separate loop to make sure
      * that all the items already have ID assigned
@@ -179,6 +192,7 @@ swdb_private::Transaction::saveItems()
     for (auto i : items) {
         i->saveReplacedBy();
     }
+    guard.commit();
 }
 
 /**
@@ -25,14 +25,33 @@ void
 SQLite3::open()
 {
     if (db == nullptr) {
-        auto result = sqlite3_open(path.c_str(), &db);
+        int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+        if (mode == Mode::READ_ONLY) {
+            flags = SQLITE_OPEN_READONLY;
+        }
+        auto result = sqlite3_open_v2(path.c_str(), &db, flags, nullptr);
         if (result != SQLITE_OK) {
             sqlite3_close(db);
+            db = nullptr;
             throw LibException(result, "Open failed");
         }
-        // sqlite doesn't behave correctly in chroots without following line:
-        // turn foreign key checking on
-        exec("PRAGMA journal_mode = TRUNCATE; PRAGMA locking_mode = EXCLUSIVE; PRAGMA foreign_keys = ON;");
+        switch (mode) {
+            case Mode::EXCLUSIVE:
+                // sqlite doesn't behave correctly in chroots without following line:
+                // turn foreign key checking on
+                exec("PRAGMA journal_mode = TRUNCATE; PRAGMA locking_mode = EXCLUSIVE; PRAGMA foreign_keys = ON;");
+                break;
+            case Mode::SHARED:
+                // wait for the writer of another connection instead of failing with SQLITE_BUSY
+                sqlite3_busy_timeout(db, BUSY_TIMEOUT_MS);
+                exec("PRAGMA journal_mode = WAL; PRAGMA locking_mode = NORMAL; PRAGMA foreign_keys = ON;");
+                break;
+            case Mode::READ_ONLY:
+                // wait for a checkpoint of the write-ahead log or for a writer holding the database
+                sqlite3_busy_timeout(db, BUSY_TIMEOUT_MS);
+                exec("PRAGMA query_only = ON;");
+                break;
+        }
     }
 }
 
@@ -41,6 +60,7 @@ SQLite3::close()
 {
     if (db == nullptr)
         return;
+    trimStatementCache(0);
     auto result = sqlite3_close(db);
     if (result == SQLITE_BUSY) {
         sqlite3_stmt *res;
@@ -56,6 +76,61 @@ SQLite3::close()
     db = nullptr;
 }
 
+sqlite3_stmt *
+SQLite3::acquireStatement(const std::string &sql)
+{
+    auto it = statementCacheIndex.find(sql);
+    if (it != statementCacheIndex.end()) {
+        auto stmt = it->second->second;
+        statementCache.erase(it->second);
+        statementCacheIndex.erase(it);
+        ++statementCacheHits;
+        return stmt;
+    }
+
+    sqlite3_stmt *stmt;
+    auto result = sqlite3_prepare_v2(db, sql.c_str(), sql.length() + 1, &stmt, nullptr);
+    if (result != SQLITE_OK)
+        throw LibException(result, "Statement: " + getError() + " in\n" + sql);
+    ++statementCacheMisses;
+    return stmt;
+}
+
+void
+SQLite3::releaseStatement(std::string &&sql, sqlite3_stmt *stmt)
+{
+    if (stmt == nullptr)
+        return;
+    if (db == nullptr || statementCacheSize == 0 || statementCacheIndex.count(sql)) {
+        sqlite3_finalize(stmt);
+        return;
+    }
+
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    statementCache.emplace_front(std::move(sql), stmt);
+    statementCacheIndex.emplace(statementCache.front().first, statementCache.begin());
+    trimStatementCache(statementCacheSize);
+}
+
+void
+SQLite3::trimStatementCache(std::size_t size)
+{
+    while (statementCache.size() > size) {
+        auto &entry = statementCache.back();
+        statementCacheIndex.erase(entry.first);
+        sqlite3_finalize(entry.second);
+        statementCache.pop_back();
+    }
+}
+
+void
+SQLite3::setStatementCacheSize(std::size_t size)
+{
+    statementCacheSize = size;
+    trimStatementCache(size);
+}
+
 void
 SQLite3::backup(const std::string &outputFile)
 {
@@ -24,10 +24,14 @@
 
 #include <sqlite3.h>
 
+#include <cstdint>
+#include <list>
 #include <map>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 class SQLite3 {
@@ -75,20 +79,22 @@ public:
         Statement(const Statement &) = delete;
         Statement &operator=(const Statement &) = delete;
 
+        /**
+         * Prepared statements are taken from the statement cache of the connection
+         * and returned there, reset and with cleared bindings, on destruction.
+         */
         Statement(SQLite3 &db, const char *sql)
           : db{db}
+          , cacheKey{sql}
+          , stmt{db.acquireStatement(cacheKey)}
         {
-            auto result = sqlite3_prepare_v2(db.db, sql, -1, &stmt, nullptr);
-            if (result != SQLITE_OK)
-                throw LibException(result, "Statement: " + db.getError() + " in\n" + sql);
         };
 
         Statement(SQLite3 &db, const std::string &sql)
           : db{db}
+          , cacheKey{sql}
+          , stmt{db.acquireStatement(cacheKey)}
         {
-            auto result = sqlite3_prepare_v2(db.db, sql.c_str(), sql.length() + 1, &stmt, nullptr);
-            if (result != SQLITE_OK)
-                throw LibException(result, "Statement: " + db.getError() + " in\n" + sql);
         };
 
         void bind(int pos, int val)
@@ -230,7 +236,7 @@ public:
         ~Statement()
         {
             freeExpandedSql();
-            sqlite3_finalize(stmt);
+            db.releaseStatement(std::move(cacheKey), stmt);
         };
 
     protected:
@@ -273,6 +279,7 @@ public:
         }
 
         SQLite3 &db;
+        std::string cacheKey;
         sqlite3_stmt *stmt;
         char *expandSql{nullptr};
     };
@@ -319,11 +326,70 @@ public:
         std::map< std::string, int > colsName2idx;
     };
 
+    /**
+     * Groups statements into one database transaction, so they are written to the disk at once.
+     * The transaction is started by the constructor and rolled back by the destructor unless
+     * commit() was called. When a transaction is already running on the connection, the guard
+     * joins it and both commit and rollback are left to the outer one.
+     */
+    class TransactionGuard {
+    public:
+        TransactionGuard(const TransactionGuard &) = delete;
+        TransactionGuard &operator=(const TransactionGuard &) = delete;
+
+        explicit TransactionGuard(SQLite3 &db)
+          : db(db)
+          , owner{db.isAutocommit()}
+        {
+            if (owner) {
+                db.exec("BEGIN IMMEDIATE");
+            }
+        }
+
+        ~TransactionGuard()
+        {
+            if (owner && !finished) {
+                // errors can't be reported from the destructor, the transaction is over anyway
+                sqlite3_exec(db.db, "ROLLBACK", nullptr, nullptr, nullptr);
+            }
+        }
+
+        void commit()
+        {
+            if (owner && !finished) {
+                db.exec("COMMIT");
+            }
+            finished = true;
+        }
+
+    private:
+        SQLite3 &db;
+        const bool owner;
+        bool finished{false};
+    };
+
+    /**
+     * How the database is shared with other connections.
+     * Modes shouldn't be mixed on a database while other connections are open, switching
+     * between EXCLUSIVE and SHARED needs the database for itself.
+     */
+    enum class Mode {
+        // read-write, the database is locked by the connection until it is closed
+        EXCLUSIVE,
+        // read-write with write-ahead log, readers aren't blocked by a writer and see the last
+        // committed state, writers of all connections take turns
+        SHARED,
+        // no writes, the database has to exist, it isn't blocked by readers of other connections
+        // nor by a writer in SHARED mode
+        READ_ONLY
+    };
+
     SQLite3(const SQLite3 &) = delete;
     SQLite3 &operator=(const SQLite3 &) = delete;
 
-    SQLite3(const std::string &dbPath)
+    SQLite3(const std::string &dbPath, Mode mode = Mode::EXCLUSIVE)
       : path{dbPath}
+      , mode{mode}
       , db{nullptr}
     {
         open();
@@ -332,6 +398,7 @@ public:
     ~SQLite3() { close(); }
 
     const std::string &getPath() const { return path; }
+    Mode getMode() const noexcept { return mode; }
 
     void open();
     void close();
@@ -345,19 +412,51 @@ public:
         }
     }
 
+    /// Returns false while a transaction is running on the connection
+    bool isAutocommit() { return sqlite3_get_autocommit(db) != 0; }
+
     int changes() { return sqlite3_changes(db); }
 
     int64_t lastInsertRowID() { return sqlite3_last_insert_rowid(db); }
 
     std::string getError() { return sqlite3_errmsg(db); }
 
+    /**
+     * Maximal number of unused prepared statements kept by the connection, 0 disables the cache.
+     * Least recently used statements are finalized first.
+     */
+    void setStatementCacheSize(std::size_t size);
+    std::size_t getStatementCacheSize() const noexcept { return statementCacheSize; }
+
+    /// Number of statements taken from the cache
+    std::uint64_t getStatementCacheHits() const noexcept { return statementCacheHits; }
+
+    /// Number of statements which had to be prepared
+    std::uint64_t getStatementCacheMisses() const noexcept { return statementCacheMisses; }
+
     void backup(const std::string &outputFile);
     void restore(const std::string &inputFile);
 
 protected:
+    sqlite3_stmt *acquireStatement(const std::string &sql);
+    void releaseStatement(std::string &&sql, sqlite3_stmt *stmt);
+    void trimStatementCache(std::size_t size);
+
+    // how long a connection which doesn't lock the database waits for others to release it
+    static constexpr int BUSY_TIMEOUT_MS = 10000;
+
     std::string path;
+    Mode mode;
 
     sqlite3 *db;
+
+    // Unused prepared statements, most recently used first. A statement in use is not in the
+    // cache, another Statement with the same SQL gets a newly prepared one.
+    std::list< std::pair< std::string, sqlite3_stmt * > > statementCache;
+    std::unordered_map< std::string, decltype(statementCache)::iterator > statementCacheIndex;
+    std::size_t statementCacheSize{64};
+    std::uint64_t statementCacheHits{0};
+    std::uint64_t statementCacheMisses{0};
 };
 
 typedef std::shared_ptr< SQLite3 > SQLite3Ptr;
@@ -184,6 +184,8 @@ PYCOMP_MOD_INIT(_hawkey)
         return PYCOMP_MOD_ERROR_VAL;
     Py_INCREF(&query_Type);
     PyModule_AddObject(m, "Query", (PyObject *)&query_Type);
+    if (PyType_Ready(&queryIterator_Type) < 0)
+        return PYCOMP_MOD_ERROR_VAL;
     /* _hawkey.Reldep */
     if (PyType_Ready(&reldep_Type) < 0)
         return PYCOMP_MOD_ERROR_VAL;
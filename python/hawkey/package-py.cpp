@@ -34,15 +34,34 @@
 #include "sack-py.hpp"
 #include "pycomp.hpp"
 #include "libdnf/repo/solvable/DependencyContainer.hpp"
+#include "libdnf/sack/packagehandle.hpp"
 
+/* The object keeps just sack and id, the DnfPackage GObject is created on the first call that
+ * needs it. Listing large query results therefore allocates no GObjects. */
 typedef struct {
     PyObject_HEAD
     DnfPackage *package;
     PyObject *sack;
+    DnfSack *csack;
+    Id id;
 } _PackageObject;
 
 long package_hash(_PackageObject *self);
 
+static DnfPackage *
+package_get(_PackageObject *self)
+{
+    if (!self->package)
+        self->package = dnf_package_new(self->csack, self->id);
+    return self->package;
+}
+
+static inline libdnf::PackageHandle
+package_handle(_PackageObject *self)
+{
+    return libdnf::PackageHandle(self->csack, self->id);
+}
+
 DnfPackage *
 packageFromPyObject(PyObject *o)
 {
@@ -50,7 +69,7 @@ packageFromPyObject(PyObject *o)
         PyErr_SetString(PyExc_TypeError, "Expected a Package object.");
         return NULL;
     }
-    return ((_PackageObject *)o)->package;
+    return package_get((_PackageObject *)o);
 }
 
 int
@@ -72,6 +91,8 @@ package_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
     if (self) {
         self->sack = NULL;
         self->package = NULL;
+        self->csack = NULL;
+        self->id = 0;
     }
     return (PyObject*)self;
 }
@@ -100,7 +121,8 @@ package_init(_PackageObject *self, PyObject *args, PyObject *kwds)
         return -1;
     self->sack = sack;
     Py_INCREF(self->sack);
-    self->package = dnf_package_new(csack, id);
+    self->csack = csack;
+    self->id = id;
     return 0;
 }
 
@@ -108,17 +130,15 @@ static PyObject *
 package_py_richcompare(PyObject *self, PyObject *other, int op)
 {
     PyObject *v;
-    DnfPackage *self_package, *other_package;
 
-    if (!package_converter(self, &self_package) ||
-        !package_converter(other, &other_package)) {
-        if(PyErr_Occurred() && PyErr_ExceptionMatches(PyExc_TypeError))
-            PyErr_Clear();
+    if (!PyType_IsSubtype(self->ob_type, &package_Type) ||
+        !PyType_IsSubtype(other->ob_type, &package_Type)) {
         Py_INCREF(Py_NotImplemented);
         return Py_NotImplemented;
     }
 
-    long result = dnf_package_cmp(self_package, other_package);
+    long result = package_handle((_PackageObject *)self).cmp(
+        package_handle((_PackageObject *)other));
 
     switch (op) {
     case Py_EQ:
@@ -150,27 +170,27 @@ package_py_richcompare(PyObject *self, PyObject *other, int op)
 static PyObject *
 package_repr(_PackageObject *self)
 {
-    DnfPackage *pkg = self->package;
-    const char *nevra = dnf_package_get_nevra(pkg);
+    auto handle = package_handle(self);
+    const char *nevra = handle.getNevra();
     PyObject *repr;
 
     repr = PyString_FromFormat("<hawkey.Package object id %ld, %s, %s>",
                                package_hash(self), nevra,
-                               dnf_package_get_reponame(pkg));
+                               handle.getReponame());
     return repr;
 }
 
 static PyObject *
 package_str(_PackageObject *self)
 {
-    const char *cstr = dnf_package_get_nevra(self->package);
+    const char *cstr = package_handle(self).getNevra();
     PyObject *ret = PyString_FromString(cstr);
     return ret;
 }
 
 long package_hash(_PackageObject *self)
 {
-    return dnf_package_get_id(self->package);
+    return self->id;
 }
 
 /* getsetters */
@@ -180,7 +200,7 @@ get_bool(_PackageObject *self, void *closure)
 {
     unsigned long (*func)(DnfPackage*);
     func = (unsigned long (*)(DnfPackage*))closure;
-    return PyBool_FromLong(func(self->package));
+    return PyBool_FromLong(func(package_get(self)));
 }
 
 static PyObject *
@@ -188,14 +208,14 @@ get_num(_PackageObject *self, void *closure)
 {
     guint64 (*func)(DnfPackage*);
     func = (guint64 (*)(DnfPackage*))closure;
-    return PyLong_FromUnsignedLongLong(func(self->package));
+    return PyLong_FromUnsignedLongLong(func(package_get(self)));
 }
 
 static PyObject *
 get_reldep(_PackageObject *self, void *closure)
 {
     DnfReldepList *(*func)(DnfPackage*) = (DnfReldepList *(*)(DnfPackage*))closure;
-    std::unique_ptr<DnfReldepList> reldeplist(func(self->package));
+    std::unique_ptr<DnfReldepList> reldeplist(func(package_get(self)));
     assert(reldeplist);
     PyObject *list = reldeplist_to_pylist(reldeplist.get(), self->sack);
 
@@ -209,7 +229,45 @@ get_str(_PackageObject *self, void *closure)
     const char *cstr;
 
     func = (const char *(*)(DnfPackage*))closure;
-    cstr = func(self->package);
+    cstr = func(package_get(self));
+    if (cstr == NULL)
+        Py_RETURN_NONE;
+    return PyUnicode_FromString(cstr);
+}
+
+/* attributes read straight from the solvable, they do not need the DnfPackage */
+static const char *
+handle_get_name(const libdnf::PackageHandle & handle)
+{
+    return handle.getName();
+}
+
+static const char *
+handle_get_arch(const libdnf::PackageHandle & handle)
+{
+    return handle.getArch();
+}
+
+static const char *
+handle_get_evr(const libdnf::PackageHandle & handle)
+{
+    return handle.getEvr();
+}
+
+static const char *
+handle_get_reponame(const libdnf::PackageHandle & handle)
+{
+    return handle.getReponame();
+}
+
+static PyObject *
+get_handle_str(_PackageObject *self, void *closure)
+{
+    const char *(*func)(const libdnf::PackageHandle &);
+    const char *cstr;
+
+    func = (const char *(*)(const libdnf::PackageHandle &))closure;
+    cstr = func(package_handle(self));
     if (cstr == NULL)
         Py_RETURN_NONE;
     return PyUnicode_FromString(cstr);
@@ -222,7 +280,7 @@ get_str_array(_PackageObject *self, void *closure)
     gchar ** strv;
 
     func = (gchar **(*)(DnfPackage*))closure;
-    strv = func(self->package);
+    strv = func(package_get(self));
     PyObject *list = strlist_to_pylist((const char **)strv);
     g_strfreev(strv);
 
@@ -237,7 +295,7 @@ get_chksum(_PackageObject *self, void *closure)
     HyChecksum *cs;
 
     func = (HyChecksum *(*)(DnfPackage*, int *))closure;
-    cs = func(self->package, &type);
+    cs = func(package_get(self), &type);
     if (cs == 0) {
         Py_RETURN_NONE;
     }
@@ -268,18 +326,18 @@ static PyGetSetDef package_getsetters[] = {
      (void *)dnf_package_get_version},
     {(char*)"release",  (getter)get_str, NULL, NULL,
      (void *)dnf_package_get_release},
-    {(char*)"name", (getter)get_str, NULL, NULL, (void *)dnf_package_get_name},
-    {(char*)"arch", (getter)get_str, NULL, NULL, (void *)dnf_package_get_arch},
+    {(char*)"name", (getter)get_handle_str, NULL, NULL, (void *)handle_get_name},
+    {(char*)"arch", (getter)get_handle_str, NULL, NULL, (void *)handle_get_arch},
     {(char*)"hdr_chksum", (getter)get_chksum, NULL, NULL,
      (void *)dnf_package_get_hdr_chksum},
     {(char*)"chksum", (getter)get_chksum, NULL, NULL, (void *)dnf_package_get_chksum},
     {(char*)"description", (getter)get_str, NULL, NULL,
      (void *)dnf_package_get_description},
-    {(char*)"evr",  (getter)get_str, NULL, NULL, (void *)dnf_package_get_evr},
+    {(char*)"evr",  (getter)get_handle_str, NULL, NULL, (void *)handle_get_evr},
     {(char*)"group",  (getter)get_str, NULL, NULL, (void *)dnf_package_get_group},
     {(char*)"license", (getter)get_str, NULL, NULL, (void *)dnf_package_get_license},
     {(char*)"packager",  (getter)get_str, NULL, NULL, (void *)dnf_package_get_packager},
-    {(char*)"reponame",  (getter)get_str, NULL, NULL, (void *)dnf_package_get_reponame},
+    {(char*)"reponame",  (getter)get_handle_str, NULL, NULL, (void *)handle_get_reponame},
     {(char*)"summary",  (getter)get_str, NULL, NULL, (void *)dnf_package_get_summary},
     {(char*)"url",  (getter)get_str, NULL, NULL, (void *)dnf_package_get_url},
     {(char*)"downloadsize", (getter)get_num, NULL, NULL,
@@ -323,7 +381,7 @@ evr_cmp(_PackageObject *self, PyObject *other)
     DnfPackage *pkg2 = packageFromPyObject(other);
     if (pkg2 == NULL)
         return NULL;
-    return PyLong_FromLong(dnf_package_evr_cmp(self->package, pkg2));
+    return PyLong_FromLong(dnf_package_evr_cmp(package_get(self), pkg2));
 }
 
 static PyObject *
@@ -332,7 +390,7 @@ get_delta_from_evr(_PackageObject *self, PyObject *evr_str)
     PycompString evr(evr_str);
     if (!evr.getCString())
         return NULL;
-    DnfPackageDelta *delta_c = dnf_package_get_delta_from_evr(self->package, evr.getCString());
+    DnfPackageDelta *delta_c = dnf_package_get_delta_from_evr(package_get(self), evr.getCString());
     if (delta_c)
         return packageDeltaToPyObject(delta_c);
     Py_RETURN_NONE;
@@ -348,7 +406,7 @@ get_advisories(_PackageObject *self, PyObject *args)
     if (!PyArg_ParseTuple(args, "i", &cmp_type))
         return NULL;
 
-    advisories = dnf_package_get_advisories(self->package, cmp_type);
+    advisories = dnf_package_get_advisories(package_get(self), cmp_type);
     list = advisorylist_to_pylist(advisories, self->sack);
     g_ptr_array_unref(advisories);
 
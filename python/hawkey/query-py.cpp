@@ -28,11 +28,13 @@
 #include "hy-query-private.hpp"
 #include "hy-selector.h"
 #include "hy-subject.h"
+#include "dnf-advisory-private.hpp"
 #include "dnf-reldep.h"
 #include "dnf-reldep-list.h"
 #include "repo/solvable/DependencyContainer.hpp"
 #include "transaction/Swdb.hpp"
 
+#include "advisory-py.hpp"
 #include "exception-py.hpp"
 #include "hawkey-pysys.hpp"
 #include "iutil-py.hpp"
@@ -246,6 +248,72 @@ get_evaluated(_QueryObject *self, void *unused)
     return PyBool_FromLong((long) q->getApplied());
 }
 
+static PyObject *
+get_profiling(_QueryObject *self, void *unused)
+{
+    return PyBool_FromLong((long) self->query->getProfiling());
+}
+
+static int
+set_profiling(_QueryObject *self, PyObject *value, void *unused)
+{
+    if (value == NULL) {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the profiling attribute");
+        return -1;
+    }
+    int enabled = PyObject_IsTrue(value);
+    if (enabled == -1)
+        return -1;
+    self->query->setProfiling(enabled);
+    return 0;
+}
+
+static PyObject *
+set_parallel(_QueryObject *self, PyObject *args, PyObject *kwds)
+{
+    const char *kwlist[] = {"threads", "min_packages", NULL};
+    unsigned int threads;
+    unsigned long long minPackages = 10000;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "I|K", (char **)kwlist, &threads, &minPackages))
+        return NULL;
+    self->query->setParallel(threads, minPackages);
+    Py_RETURN_NONE;
+}
+
+static const char *
+keyname_to_char(int keyname)
+{
+    for (unsigned i = 0; keyname_char_matches[i] != NULL; ++i) {
+        if (keyname_int_matches[i] == keyname)
+            return keyname_char_matches[i];
+    }
+    return "unknown";
+}
+
+static PyObject *
+get_profile(_QueryObject *self, void *unused)
+{
+    auto & profile = self->query->getProfile();
+    UniquePtrPyObject list(PyList_New(profile.size()));
+    if (!list)
+        return NULL;
+    for (size_t i = 0; i < profile.size(); ++i) {
+        auto & record = profile[i];
+        PyObject *item = Py_BuildValue("{s:s,s:i,s:d,s:n,s:n,s:O}",
+                                       "keyname", keyname_to_char(record.keyname),
+                                       "cmp_type", record.cmpType,
+                                       "seconds", record.seconds,
+                                       "count_in", (Py_ssize_t) record.countBefore,
+                                       "count_out", (Py_ssize_t) record.countAfter,
+                                       "index_used", record.indexUsed ? Py_True : Py_False);
+        if (!item)
+            return NULL;
+        PyList_SET_ITEM(list.get(), i, item);
+    }
+    return list.release();
+}
+
 static PyObject *
 clear(_QueryObject *self, PyObject *unused)
 {
@@ -693,6 +761,43 @@ get_advisory_pkgs(_QueryObject *self, PyObject *args)
     return advisoryPkgVectorToPylist(advisoryPkgs);
 }
 
+static PyObject *
+get_package_advisories(_QueryObject *self, PyObject *args)
+{
+    int cmpType;
+
+    if (!PyArg_ParseTuple(args, "i", &cmpType))
+        return NULL;
+
+    std::vector<std::pair<Id, Id>> pkgAdvisories;
+    self->query->getPackageAdvisories(cmpType, pkgAdvisories);
+
+    DnfSack *csack = self->query->getSack();
+    UniquePtrPyObject dict(PyDict_New());
+    if (!dict)
+        return NULL;
+    UniquePtrPyObject list;
+    Id lastPkg = 0;
+    for (auto & pkgAdvisory : pkgAdvisories) {
+        if (pkgAdvisory.first != lastPkg) {
+            lastPkg = pkgAdvisory.first;
+            UniquePtrPyObject package(new_package(self->sack, pkgAdvisory.first));
+            list.reset(PyList_New(0));
+            if (!package || !list)
+                return NULL;
+            if (PyDict_SetItem(dict.get(), package.get(), list.get()) == -1)
+                return NULL;
+        }
+        UniquePtrPyObject advisory(
+            advisoryToPyObject(dnf_advisory_new(csack, pkgAdvisory.second), self->sack));
+        if (!advisory)
+            return NULL;
+        if (PyList_Append(list.get(), advisory.get()) == -1)
+            return NULL;
+    }
+    return dict.release();
+}
+
 static PyObject *
 filter_userinstalled(PyObject *self, PyObject *args, PyObject *kwds)
 {
@@ -824,14 +929,79 @@ query_get_item_by_pyindex(PyObject *self, PyObject *index)
     return query_get_item(self, (int) PyLong_AsLong(index));
 }
 
+/* Iterator over a snapshot of the query result, packages are created one at a time as they are
+ * consumed. */
+typedef struct {
+    PyObject_HEAD
+    libdnf::PackageSet *pset;
+    PyObject *sack;
+    Id id;
+} _QueryIteratorObject;
+
+static void
+query_iterator_dealloc(_QueryIteratorObject *self)
+{
+    delete self->pset;
+    Py_XDECREF(self->sack);
+    PyObject_Del(self);
+}
+
+static PyObject *
+query_iterator_next(_QueryIteratorObject *self)
+{
+    if (!self->pset)
+        return NULL;
+    self->id = self->pset->next(self->id);
+    if (self->id == -1) {
+        delete self->pset;
+        self->pset = NULL;
+        return NULL;
+    }
+    return new_package(self->sack, self->id);
+}
+
+PyTypeObject queryIterator_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_hawkey.QueryIterator",        /*tp_name*/
+    sizeof(_QueryIteratorObject),   /*tp_basicsize*/
+    0,                                /*tp_itemsize*/
+    (destructor) query_iterator_dealloc, /*tp_dealloc*/
+    0,                                /*tp_print*/
+    0,                                /*tp_getattr*/
+    0,                                /*tp_setattr*/
+    0,                                /*tp_compare*/
+    0,                                /*tp_repr*/
+    0,                                /*tp_as_number*/
+    0,                                /*tp_as_sequence*/
+    0,                                /*tp_as_mapping*/
+    0,                                /*tp_hash */
+    0,                                /*tp_call*/
+    0,                                /*tp_str*/
+    0,                                /*tp_getattro*/
+    0,                                /*tp_setattro*/
+    0,                                /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,               /*tp_flags*/
+    "Query iterator object",        /* tp_doc */
+    0,                                /* tp_traverse */
+    0,                                /* tp_clear */
+    0,                                /* tp_richcompare */
+    0,                                /* tp_weaklistoffset */
+    PyObject_SelfIter,                /* tp_iter */
+    (iternextfunc) query_iterator_next, /* tp_iternext */
+};
+
 static PyObject *
 query_iter(PyObject *self)
 {
     const DnfPackageSet * pset = ((_QueryObject *) self)->query->runSet();
-    UniquePtrPyObject list(packageset_to_pylist(pset, ((_QueryObject *) self)->sack));
-    PyObject *iter = PyObject_GetIter(list.get());
-    Py_INCREF(iter);
-    return iter;
+    auto iter = PyObject_New(_QueryIteratorObject, &queryIterator_Type);
+    if (!iter)
+        return NULL;
+    iter->pset = new libdnf::PackageSet(*pset);
+    iter->sack = ((_QueryObject *) self)->sack;
+    Py_INCREF(iter->sack);
+    iter->id = -1;
+    return (PyObject *) iter;
 }
 
 static PyObject *
@@ -984,6 +1154,8 @@ add_filter_recent(_QueryObject *self, PyObject *args)
 
 static PyGetSetDef query_getsetters[] = {
     {(char*)"evaluated",  (getter)get_evaluated, NULL, NULL, NULL},
+    {(char*)"profiling",  (getter)get_profiling, (setter)set_profiling, NULL, NULL},
+    {(char*)"profile",  (getter)get_profile, NULL, NULL, NULL},
     {NULL}                        /* sentinel */
 };
 
@@ -1003,6 +1175,7 @@ static struct PyMethodDef query_methods[] = {
      NULL},
     {"run", (PyCFunction)run, METH_NOARGS,
      NULL},
+    {"set_parallel", (PyCFunction)set_parallel, METH_KEYWORDS|METH_VARARGS, NULL},
     {"apply", (PyCFunction)apply, METH_NOARGS,
      NULL},
     {"available", (PyCFunction)add_available_filter, METH_NOARGS, NULL},
@@ -1018,6 +1191,7 @@ static struct PyMethodDef query_methods[] = {
     {"count", (PyCFunction)q_length, METH_NOARGS,
         NULL},
     {"get_advisory_pkgs", (PyCFunction)get_advisory_pkgs, METH_VARARGS, NULL},
+    {"get_package_advisories", (PyCFunction)get_package_advisories, METH_VARARGS, NULL},
     {"userinstalled", (PyCFunction)filter_userinstalled, METH_KEYWORDS|METH_VARARGS, NULL},
     {"_na_dict", (PyCFunction)query_to_name_arch_dict, METH_NOARGS, NULL},
     {"_name_dict", (PyCFunction)query_to_name_dict, METH_NOARGS, NULL},
@@ -24,6 +24,7 @@
 #include "hy-types.h"
 
 extern PyTypeObject query_Type;
+extern PyTypeObject queryIterator_Type;
 
 #define queryObject_Check(o)        PyObject_TypeCheck(o, &query_Type)
 
@@ -312,10 +312,31 @@ set_installonly_limit(_SackObject *self, PyObject *obj, void *unused)
     return 0;
 }
 
+static PyObject *
+get_query_cache(_SackObject *self, void *unused)
+{
+    return PyBool_FromLong((long) dnf_sack_get_query_cache_enabled(self->sack));
+}
+
+static int
+set_query_cache(_SackObject *self, PyObject *obj, void *unused)
+{
+    if (obj == NULL) {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the query_cache attribute");
+        return -1;
+    }
+    int enabled = PyObject_IsTrue(obj);
+    if (enabled == -1)
+        return -1;
+    dnf_sack_set_query_cache_enabled(self->sack, enabled);
+    return 0;
+}
+
 static PyGetSetDef sack_getsetters[] = {
     {(char*)"cache_dir",        (getter)get_cache_dir, NULL, NULL, NULL},
     {(char*)"installonly",        NULL, (setter)set_installonly, NULL, NULL},
     {(char*)"installonly_limit",        NULL, (setter)set_installonly_limit, NULL, NULL},
+    {(char*)"query_cache",        (getter)get_query_cache, (setter)set_query_cache, NULL, NULL},
     {NULL}                        /* sentinel */
 };
 
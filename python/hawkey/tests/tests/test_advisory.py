@@ -44,9 +44,9 @@ class Test(base.TestCase):
 
     def setUp(self):
         """Prepare the test fixture."""
-        sack = base.TestSack(repo_dir=self.repo_dir)
-        sack.load_repo(load_updateinfo=True)
-        self.advisory = find_advisory(sack, 'FEDORA-2008-9969')
+        self.sack = base.TestSack(repo_dir=self.repo_dir)
+        self.sack.load_repo(load_updateinfo=True)
+        self.advisory = find_advisory(self.sack, 'FEDORA-2008-9969')
 
     def test_description(self):
         self.assertEqual(self.advisory.description, 'An example update to the tour package.')
@@ -58,6 +58,17 @@ class Test(base.TestCase):
     def test_id(self):
         self.assertEqual(self.advisory.id, 'FEDORA-2008-9969')
 
+    def test_package_advisories(self):
+        for cmp_type in (hawkey.LT, hawkey.GT | hawkey.EQ):
+            query = hawkey.Query(self.sack)
+            advisories = query.get_package_advisories(cmp_type)
+            expected = {pkg: pkg.get_advisories(cmp_type) for pkg in query}
+            expected = {pkg: advs for pkg, advs in expected.items() if advs}
+            self.assertEqual(advisories, expected)
+        advisories = hawkey.Query(self.sack).filter(name='tour').get_package_advisories(hawkey.GT)
+        ids = [adv.id for advs in advisories.values() for adv in advs]
+        self.assertIn('FEDORA-2008-9969', ids)
+
     def test_references(self):
         urls = [ref.url for ref in self.advisory.references]
         self.assertEqual(urls,
@@ -98,6 +98,19 @@ class TestQuery(base.TestCase):
         self.assertEqual(q.count(), 2)
         self.assertNotEqual(q[0], q[1])
 
+    def test_iterator(self):
+        q = hawkey.Query(self.sack)
+        it = iter(q)
+        self.assertIs(iter(it), it)
+        self.assertEqual(next(it), q[0])
+        self.assertEqual(list(it), q.run()[1:])
+        self.assertRaises(StopIteration, next, it)
+
+        # the iterator keeps the result it was created for
+        it = iter(q)
+        q.filterm(name="penny")
+        self.assertGreater(len(list(it)), len(q))
+
     def test_clone(self):
         q = hawkey.Query(self.sack)
         q.filterm(name__substr=["penny"])
@@ -358,6 +371,37 @@ class TestQueryUpdates(base.TestCase):
         self.assertLength(o, 1)
         self.assertEqual(str(o[0]), "fool-1-5.noarch")
 
+    def test_profile(self):
+        q = hawkey.Query(self.sack)
+        self.assertFalse(q.profiling)
+        q.profiling = True
+        q = q.filter(name="penny", arch__neq="src")
+        self.assertTrue(q.profiling)
+        self.assertLength(q.run(), 1)
+        profile = q.profile
+        self.assertLength(profile, 2)
+        # filters of the same cost keep their order, find the records by key
+        records = {record["keyname"]: record for record in profile}
+        self.assertEqual(sorted(records), ["arch", "name"])
+        name = records["name"]
+        self.assertTrue(name["index_used"])
+        self.assertEqual(name["count_out"], 1)
+        self.assertGreaterEqual(name["count_in"], 1)
+        self.assertGreaterEqual(name["seconds"], 0)
+        # a derived query doesn't inherit the records of filters it didn't run
+        derived = q.filter(evr="4-1")
+        self.assertTrue(derived.profiling)
+        self.assertEqual(derived.profile, [])
+        q.profiling = False
+        self.assertEqual(q.profile, [])
+
+    def test_parallel(self):
+        q = hawkey.Query(self.sack)
+        q.set_parallel(4, min_packages=0)
+        parallel = q.filter(name__glob="*e*")
+        expected = hawkey.Query(self.sack).filter(name__glob="*e*")
+        self.assertItemsEqual(parallel.run(), expected.run())
+
     def test_subquery_evaluated(self):
         q = hawkey.Query(self.sack).filter(name="penny")
         self.assertFalse(q.evaluated)
@@ -24,6 +24,7 @@
 #include "libdnf/dnf-advisorypkg.h"
 #include "libdnf/dnf-advisoryref.h"
 #include "libdnf/hy-package.h"
+#include "libdnf/dnf-sack-private.hpp"
 #include "fixtures.h"
 #include "test_suites.h"
 #include "testsys.h"
@@ -125,6 +126,34 @@ START_TEST(test_refs)
 }
 END_TEST
 
+START_TEST(test_index)
+{
+    DnfSack *sack = test_globals.sack;
+    Pool *pool = dnf_sack_get_pool(sack);
+    const libdnf::AdvisoryIndex & index = dnf_sack_get_advisory_index(sack);
+
+    ck_assert_int_eq(index.findByName("FEDORA-2008-9969").size(), 1);
+    ck_assert_int_eq(index.findByBug("472090").size(), 1);
+    ck_assert_int_eq(index.findByCVE("472091").size(), 1);
+    ck_assert_int_eq(index.findByCVE("472090").size(), 0);
+    ck_assert_int_eq(index.findByType("security").size(), 1);
+    ck_assert_int_eq(index.findBySeverity("Critical").size(), 0);
+    fail_unless(index.findByName("FEDORA-2008-9969") != index.findByType("security"));
+
+    Id tour = pool_str2id(pool, "tour", 0);
+    Id noarch = pool_str2id(pool, "noarch", 0);
+    auto range = index.find(tour, noarch);
+    ck_assert_int_eq(range.second - range.first, 2);
+    range = index.find(tour, noarch, range.first->evr);
+    ck_assert_int_eq(range.second - range.first, 1);
+    range = index.find(tour, pool_str2id(pool, "x86_64", 0));
+    fail_unless(range.first == range.second);
+
+    // the index is the same object until the pool changes
+    fail_unless(&index == &dnf_sack_get_advisory_index(sack));
+}
+END_TEST
+
 Suite *
 advisory_suite(void)
 {
@@ -141,6 +170,7 @@ advisory_suite(void)
     tcase_add_test(tc, test_updated);
     tcase_add_test(tc, test_packages);
     tcase_add_test(tc, test_refs);
+    tcase_add_test(tc, test_index);
     suite_add_tcase(s, tc);
 
     return s;
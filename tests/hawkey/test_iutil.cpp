@@ -19,6 +19,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <glib.h>
 
@@ -122,6 +123,53 @@ START_TEST(test_checksum_write_read)
 }
 END_TEST
 
+START_TEST(test_checksum_fn)
+{
+    char *new_file = solv_dupjoin(test_globals.tmpdir,
+                                  "/test_checksum_fn", NULL);
+    build_test_file(new_file);
+
+    unsigned char cs_fp[CHKSUM_BYTES];
+    unsigned char cs_fn[CHKSUM_BYTES];
+    FILE *fp = fopen(new_file, "r");
+    fail_if(checksum_fp(cs_fp, fp));
+    fclose(fp);
+    fail_if(checksum_fn(cs_fn, new_file));
+    fail_if(checksum_cmp(cs_fp, cs_fn));
+
+    fail_unless(checksum_fn(cs_fn, "/non/existing/file"));
+    g_free(new_file);
+}
+END_TEST
+
+START_TEST(test_checksum_open_matching)
+{
+    char *new_file = solv_dupjoin(test_globals.tmpdir,
+                                  "/test_checksum_open_matching", NULL);
+    build_test_file(new_file);
+
+    unsigned char cs_computed[CHKSUM_BYTES];
+    unsigned char cs_other[CHKSUM_BYTES];
+    FILE *fp = fopen(new_file, "r+");
+    checksum_fp(cs_computed, fp);
+    fail_if(checksum_write(cs_computed, fp));
+    fclose(fp);
+
+    fp = checksum_open_matching(new_file, cs_computed);
+    fail_if(fp == NULL);
+    // the stream starts at the beginning of the file
+    fail_unless(ftell(fp) == 0);
+    fclose(fp);
+
+    memcpy(cs_other, cs_computed, CHKSUM_BYTES);
+    cs_other[0] ^= 0xff;
+    fail_unless(checksum_open_matching(new_file, cs_other) == NULL);
+    fail_unless(checksum_open_matching("/non/existing/file", cs_computed) == NULL);
+
+    g_free(new_file);
+}
+END_TEST
+
 START_TEST(test_mkcachedir)
 {
     const char *workdir = test_globals.tmpdir;
@@ -182,6 +230,8 @@ iutil_suite(void)
     tcase_add_test(tc, test_abspath);
     tcase_add_test(tc, test_checksum);
     tcase_add_test(tc, test_checksum_write_read);
+    tcase_add_test(tc, test_checksum_fn);
+    tcase_add_test(tc, test_checksum_open_matching);
     tcase_add_test(tc, test_mkcachedir);
     tcase_add_test(tc, test_version_split);
     suite_add_tcase(s, tc);
@@ -36,6 +36,7 @@
 
 #include "libdnf/repo/solvable/Dependency.hpp"
 #include "libdnf/repo/solvable/DependencyContainer.hpp"
+#include "libdnf/sack/packagehandle.hpp"
 
 START_TEST(test_package_summary)
 {
@@ -61,6 +62,32 @@ START_TEST(test_identical)
 }
 END_TEST
 
+START_TEST(test_handle)
+{
+    DnfSack *sack = test_globals.sack;
+    DnfPackage *pkg1 = by_name(sack, "penny-lib");
+    DnfPackage *pkg2 = by_name(sack, "flying");
+    libdnf::PackageHandle handle1(sack, dnf_package_get_id(pkg1));
+    libdnf::PackageHandle handle2(sack, dnf_package_get_id(pkg2));
+
+    ck_assert_str_eq(handle1.getName(), dnf_package_get_name(pkg1));
+    ck_assert_str_eq(handle1.getArch(), dnf_package_get_arch(pkg1));
+    ck_assert_str_eq(handle1.getEvr(), dnf_package_get_evr(pkg1));
+    ck_assert_str_eq(handle1.getReponame(), dnf_package_get_reponame(pkg1));
+    ck_assert_str_eq(handle1.getNevra(), dnf_package_get_nevra(pkg1));
+    fail_unless(handle1.cmp(handle2) == dnf_package_cmp(pkg1, pkg2));
+    fail_unless(handle1.cmp(handle1) == 0);
+    fail_if(handle1 == handle2);
+
+    DnfPackage *pkg3 = handle1.toDnfPackage();
+    fail_unless(dnf_package_get_identical(pkg1, pkg3));
+
+    g_object_unref(pkg1);
+    g_object_unref(pkg2);
+    g_object_unref(pkg3);
+}
+END_TEST
+
 START_TEST(test_versions)
 {
     DnfSack *sack = test_globals.sack;
@@ -349,6 +376,7 @@ package_suite(void)
     tcase_add_unchecked_fixture(tc, fixture_system_only, teardown);
     tcase_add_test(tc, test_package_summary);
     tcase_add_test(tc, test_identical);
+    tcase_add_test(tc, test_handle);
     tcase_add_test(tc, test_versions);
     tcase_add_test(tc, test_no_sourcerpm);
     suite_add_tcase(s, tc);
@@ -24,6 +24,7 @@
 #include "libdnf/dnf-sack-private.hpp"
 #include "fixtures.h"
 #include "test_suites.h"
+#include "libdnf/sack/bitmap.hpp"
 #include "libdnf/sack/packageset.hpp"
 
 static DnfPackageSet *pset;
@@ -169,6 +170,110 @@ START_TEST(test_get_pkgid)
 }
 END_TEST
 
+START_TEST(test_bitmap_ops)
+{
+    DnfSack *sack = test_globals.sack;
+    int max = dnf_sack_last_solvable(sack);
+    libdnf::PackageSet odd(sack);
+    libdnf::PackageSet low(sack);
+    for (Id id = 1; id <= max; id += 2)
+        odd.set(id);
+    for (Id id = 0; id <= max && id < 70; ++id)
+        low.set(id);
+
+    // iteration crosses byte and word boundaries
+    size_t count = 0;
+    for (Id id = odd.next(-1); id != -1; id = odd.next(id)) {
+        fail_unless(id % 2 == 1);
+        fail_unless(odd[count] == id);
+        ++count;
+    }
+    fail_unless(count == odd.size());
+    fail_unless(odd[count] == -1);
+
+    libdnf::PackageSet both(odd);
+    libdnf::bitmapAnd(both.getMap(), low.getMap());
+    libdnf::PackageSet oddOnly(odd);
+    libdnf::bitmapSubtract(oddOnly.getMap(), low.getMap());
+    libdnf::PackageSet any(odd);
+    libdnf::bitmapOr(any.getMap(), low.getMap());
+    for (Id id = 0; id <= max; ++id) {
+        fail_unless(both.has(id) == (odd.has(id) && low.has(id)));
+        fail_unless(oddOnly.has(id) == (odd.has(id) && !low.has(id)));
+        fail_unless(any.has(id) == (odd.has(id) || low.has(id)));
+    }
+    fail_if(libdnf::bitmapEmpty(both.getMap()));
+    libdnf::bitmapSubtract(both.getMap(), odd.getMap());
+    fail_unless(libdnf::bitmapEmpty(both.getMap()));
+}
+END_TEST
+
+START_TEST(test_sparse)
+{
+    DnfSack *sack = test_globals.sack;
+    int max = dnf_sack_last_solvable(sack);
+    libdnf::PackageSet small(sack);
+    small.set(9);
+    small.set(max);
+    small.set(0);
+    small.set(9);
+    fail_unless(small.size() == 3);
+    fail_unless(small[0] == 0 && small[1] == 9 && small[2] == max);
+    fail_unless(small[3] == -1);
+    fail_unless(small.next(0) == 9);
+    fail_unless(small.next(max) == -1);
+    small.remove(9);
+    fail_if(small.has(9));
+    fail_unless(small.size() == 2);
+
+    libdnf::PackageSet other(sack);
+    other.set(1);
+    other.set(max);
+    small += other;
+    fail_unless(small.size() == 3);
+    fail_unless(small[1] == 1);
+
+    // the set stays consistent once converted to a bitmap and back
+    Map *map = small.getMap();
+    fail_unless(MAPTST(map, 0) && MAPTST(map, 1) && MAPTST(map, max));
+    MAPSET(map, 2);
+    fail_unless(small.has(2));
+    fail_unless(small.size() == 4);
+    libdnf::PackageSet copy(small);
+    fail_unless(copy.size() == 4);
+    fail_unless(copy.next(1) == 2);
+    copy += other;
+    fail_unless(copy.size() == 4);
+    copy.clear();
+    fail_unless(copy.size() == 0);
+    fail_unless(copy.next(-1) == -1);
+}
+END_TEST
+
+START_TEST(test_union_after_pool_grew)
+{
+    DnfSack *sack = test_globals.sack;
+    libdnf::PackageSet all(sack);
+    for (Id id = 0; id <= dnf_sack_last_solvable(sack); ++id)
+        all.set(id);
+    all.getMap();
+
+    // each call adds a solvable, eight of them do not fit into the bitmap of all
+    g_autofree gchar *path = g_build_filename(TESTDATADIR, "/hawkey/yum/tour-4-6.noarch.rpm", NULL);
+    libdnf::PackageSet added(sack);
+    for (int i = 0; i < 8; ++i) {
+        g_autoptr(DnfPackage) pkg = dnf_sack_add_cmdline_package(sack, path);
+        fail_if(pkg == NULL);
+        added.set(pkg);
+    }
+    size_t count = all.size();
+    all += added;
+    fail_unless(all.size() == count + 8);
+    for (Id id : added)
+        fail_unless(all.has(id));
+}
+END_TEST
+
 Suite *
 packageset_suite(void)
 {
@@ -180,6 +285,9 @@ packageset_suite(void)
     tcase_add_test(tc, test_has);
     tcase_add_test(tc, test_get_clone);
     tcase_add_test(tc, test_get_pkgid);
+    tcase_add_test(tc, test_bitmap_ops);
+    tcase_add_test(tc, test_sparse);
+    tcase_add_test(tc, test_union_after_pool_grew);
     suite_add_tcase(s, tc);
 
     return s;
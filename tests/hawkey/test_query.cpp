@@ -19,6 +19,8 @@
  */
 
 #include <check.h>
+#include <fnmatch.h>
+#include <vector>
 
 
 #include <solv/testcase.h>
@@ -48,6 +50,16 @@ size_and_free(HyQuery query)
     return c;
 }
 
+/* Checks that result holds exactly the packages of a non-empty expected set. */
+static void
+assert_same_packages(const libdnf::PackageSet & result, const libdnf::PackageSet & expected)
+{
+    fail_if(expected.size() == 0);
+    ck_assert_int_eq(result.size(), expected.size());
+    for (Id id : expected)
+        fail_unless(result.has(id));
+}
+
 START_TEST(test_query_sanity)
 {
     DnfSack *sack = test_globals.sack;
@@ -923,6 +935,187 @@ START_TEST(test_query_apply)
 }
 END_TEST
 
+START_TEST(test_query_plan)
+{
+    std::vector<int> executed;
+    auto trace = [&executed](const libdnf::Filter & f, size_t, size_t, double) {
+        executed.push_back(f.getKeyname());
+    };
+
+    // cheaper filters run first, the result does not change
+    HyQuery q = hy_query_create(test_globals.sack);
+    q->setTraceCallback(trace);
+    hy_query_filter(q, HY_PKG_NAME, HY_SUBSTR, "penny");
+    hy_query_filter(q, HY_PKG_ARCH, HY_NEQ, "src");
+    fail_unless(query_count_results(q) == 2);
+    ck_assert_int_eq(executed.size(), 2);
+    ck_assert_int_eq(executed[0], HY_PKG_ARCH);
+    ck_assert_int_eq(executed[1], HY_PKG_NAME);
+    hy_query_free(q);
+
+    // filters are not moved over order dependent filters
+    executed.clear();
+    q = hy_query_create(test_globals.sack);
+    q->setTraceCallback(trace);
+    hy_query_filter(q, HY_PKG_NAME, HY_SUBSTR, "penny");
+    hy_query_filter_latest(q, 1);
+    hy_query_filter(q, HY_PKG_ARCH, HY_NEQ, "src");
+    hy_query_apply(q);
+    ck_assert_int_eq(executed.size(), 3);
+    ck_assert_int_eq(executed[0], HY_PKG_NAME);
+    ck_assert_int_eq(executed[1], HY_PKG_LATEST);
+    ck_assert_int_eq(executed[2], HY_PKG_ARCH);
+    hy_query_free(q);
+
+    // remaining filters are skipped once the query is empty
+    executed.clear();
+    q = hy_query_create(test_globals.sack);
+    q->setTraceCallback(trace);
+    hy_query_filter_provides(q, HY_GT, "fool", "0");
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "lane");
+    fail_if(query_count_results(q));
+    ck_assert_int_eq(executed.size(), 1);
+    ck_assert_int_eq(executed[0], HY_PKG_NAME);
+    hy_query_free(q);
+}
+END_TEST
+
+START_TEST(test_query_iterator)
+{
+    HyQuery q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_SUBSTR, "penny");
+    g_autoptr(GPtrArray) plist = hy_query_run(q);
+
+    unsigned int count = 0;
+    for (auto handle : *q) {
+        fail_unless(count < plist->len);
+        auto pkg = static_cast<DnfPackage *>(g_ptr_array_index(plist, count));
+        ck_assert_int_eq(handle.getId(), dnf_package_get_id(pkg));
+        ck_assert_str_eq(handle.getName(), dnf_package_get_name(pkg));
+        ++count;
+    }
+    ck_assert_int_eq(count, plist->len);
+
+    Id cursor = -1;
+    count = 0;
+    DnfPackage *pkg;
+    while ((pkg = hy_query_next_package(q, &cursor)) != NULL) {
+        fail_unless(count < plist->len);
+        fail_unless(dnf_package_get_identical(
+            pkg, static_cast<DnfPackage *>(g_ptr_array_index(plist, count))));
+        g_object_unref(pkg);
+        ++count;
+    }
+    ck_assert_int_eq(count, plist->len);
+    ck_assert_int_eq(cursor, -1);
+    hy_query_free(q);
+}
+END_TEST
+
+START_TEST(test_query_parallel)
+{
+    struct {
+        int keyname;
+        int cmpType;
+        const char *match;
+    } filters[] = {
+        {HY_PKG_NAME, HY_GLOB, "*e*"},
+        {HY_PKG_NAME, HY_SUBSTR | HY_ICASE, "PENNY"},
+        {HY_PKG_NAME, HY_GLOB | HY_NOT, "p*"},
+        {HY_PKG_REQUIRES, HY_GLOB, "*"},
+        {HY_PKG_CONFLICTS, HY_GLOB, "*"},
+        {HY_PKG_OBSOLETES, HY_GLOB, "*"},
+    };
+
+    // minPackages 0 forces the thread pool even for the small fixture
+    for (auto & filter : filters) {
+        libdnf::Query serial(test_globals.sack);
+        serial.addFilter(filter.keyname, filter.cmpType, filter.match);
+        libdnf::Query parallel(test_globals.sack);
+        parallel.setParallel(4, 0);
+        parallel.addFilter(filter.keyname, filter.cmpType, filter.match);
+
+        assert_same_packages(*parallel.runSet(), *serial.runSet());
+    }
+}
+END_TEST
+
+START_TEST(test_query_string_matcher)
+{
+    // the patterns cover the literal, prefix, suffix, substring and generic glob matchers
+    const char *patterns[] = {"penny", "p*", "*b", "*e*", "*", "?enn[xy]*", "PENNY*", "1*", "*.*"};
+    const int keynames[] = {HY_PKG_NAME, HY_PKG_ARCH, HY_PKG_VERSION, HY_PKG_RELEASE};
+    const int cmpFlags[] = {0, HY_ICASE};
+
+    HyQuery all = hy_query_create(test_globals.sack);
+    g_autoptr(GPtrArray) plist = hy_query_run(all);
+    hy_query_free(all);
+
+    for (auto keyname : keynames) {
+        for (auto pattern : patterns) {
+            for (auto flags : cmpFlags) {
+                if (flags && keyname != HY_PKG_NAME)
+                    continue;
+                HyQuery q = hy_query_create(test_globals.sack);
+                hy_query_filter(q, keyname, HY_GLOB | flags, pattern);
+                DnfPackageSet *pset = hy_query_run_set(q);
+
+                size_t expected = 0;
+                for (guint i = 0; i < plist->len; ++i) {
+                    auto pkg = static_cast<DnfPackage *>(g_ptr_array_index(plist, i));
+                    const char *value;
+                    if (keyname == HY_PKG_NAME)
+                        value = dnf_package_get_name(pkg);
+                    else if (keyname == HY_PKG_ARCH)
+                        value = dnf_package_get_arch(pkg);
+                    else if (keyname == HY_PKG_VERSION)
+                        value = dnf_package_get_version(pkg);
+                    else
+                        value = dnf_package_get_release(pkg);
+                    bool match = fnmatch(pattern, value, flags ? FNM_CASEFOLD : 0) == 0;
+                    fail_unless(match == (dnf_packageset_has(pset, pkg) != 0));
+                    expected += match;
+                }
+                ck_assert_int_eq(dnf_packageset_count(pset), expected);
+                dnf_packageset_free(pset);
+                hy_query_free(q);
+            }
+        }
+    }
+}
+END_TEST
+
+START_TEST(test_query_evr_patterns)
+{
+    // several patterns in one filter select the union of the single pattern filters
+    struct {
+        int keyname;
+        int cmpType;
+        const char *matches[3];
+    } filters[] = {
+        {HY_PKG_VERSION, HY_EQ, {"4", "5.0", NULL}},
+        {HY_PKG_VERSION, HY_GT, {"5.2.1", "1", NULL}},
+        {HY_PKG_VERSION, HY_LT | HY_EQ, {"4", "0.1", NULL}},
+        {HY_PKG_RELEASE, HY_EQ, {"1", "3", NULL}},
+        {HY_PKG_RELEASE, HY_LT, {"2", "1", NULL}},
+    };
+
+    for (auto & filter : filters) {
+        libdnf::Query both(test_globals.sack);
+        both.addFilter(filter.keyname, filter.cmpType, filter.matches);
+        auto result = both.runSet();
+
+        libdnf::PackageSet expected(test_globals.sack);
+        for (int i = 0; filter.matches[i]; ++i) {
+            libdnf::Query single(test_globals.sack);
+            single.addFilter(filter.keyname, filter.cmpType, filter.matches[i]);
+            expected += *single.runSet();
+        }
+        assert_same_packages(*result, expected);
+    }
+}
+END_TEST
+
 START_TEST(test_filter_advisory)
 {
     HyQuery q = hy_query_create(test_globals.sack);
@@ -1042,6 +1235,8 @@ query_suite(void)
     tcase_add_test(tc, test_query_nevra_glob);
     tcase_add_test(tc, test_query_multiple_flags);
     tcase_add_test(tc, test_query_apply);
+    tcase_add_test(tc, test_query_plan);
+    tcase_add_test(tc, test_query_iterator);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Updates");
@@ -1062,6 +1257,8 @@ query_suite(void)
     tcase_add_test(tc, test_query_provides_str);
     tcase_add_test(tc, test_query_provides_glob);
     tcase_add_test(tc, test_query_rco_glob);
+    tcase_add_test(tc, test_query_string_matcher);
+    tcase_add_test(tc, test_query_evr_patterns);
     tcase_add_test(tc, test_query_recommends);
     tcase_add_test(tc, test_query_suggests);
     tcase_add_test(tc, test_query_supplements);
@@ -1077,6 +1274,7 @@ query_suite(void)
     tcase_add_test(tc, test_filter_latest_archs);
     tcase_add_test(tc, test_filter_obsoletes);
     tcase_add_test(tc, test_filter_reponames);
+    tcase_add_test(tc, test_query_parallel);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Filelists etc.");
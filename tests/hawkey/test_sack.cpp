@@ -18,13 +18,16 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <algorithm>
 #include <check.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <sys/types.h>
+#include <vector>
 
 
+#include <solv/evr.h>
 #include <solv/testcase.h>
 
 #include <glib/gstdio.h>
@@ -35,6 +38,7 @@
 #include "libdnf/dnf-sack-private.hpp"
 #include "libdnf/hy-util.h"
 #include "libdnf/hy-iutil-private.hpp"
+#include "libdnf/sack/query.hpp"
 #include "fixtures.h"
 #include "testsys.h"
 #include "test_suites.h"
@@ -154,6 +158,71 @@ START_TEST(test_add_cmdline_package)
 }
 END_TEST
 
+START_TEST(test_name_index)
+{
+    g_autoptr(DnfSack) sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, test_globals.tmpdir);
+    Pool *pool = dnf_sack_get_pool(sack);
+    int count;
+
+    g_autofree gchar *path_tour = g_build_filename (TESTDATADIR, "/hawkey/yum/tour-4-6.noarch.rpm", NULL);
+    g_autoptr(DnfPackage) pkg_tour = dnf_sack_add_cmdline_package (sack, path_tour);
+    Id name = pool_str2id(pool, "tour", 0);
+    const Id *ids = dnf_sack_get_name_index(sack, name, &count);
+    fail_unless(count == 1);
+    fail_unless(ids[0] == dnf_package_get_id(pkg_tour));
+
+    // adding a package has to drop the index built above
+    g_autofree gchar *path_mystery = g_build_filename (TESTDATADIR, "/hawkey/yum/mystery-devel-19.67-1.noarch.rpm", NULL);
+    g_autoptr(DnfPackage) pkg_mystery = dnf_sack_add_cmdline_package (sack, path_mystery);
+    name = pool_str2id(pool, "mystery-devel", 0);
+    ids = dnf_sack_get_name_index(sack, name, &count);
+    fail_unless(count == 1);
+    fail_unless(ids[0] == dnf_package_get_id(pkg_mystery));
+
+    dnf_sack_get_name_index(sack, pool_str2id(pool, "noarch", 0), &count);
+    fail_unless(count == 0);
+}
+END_TEST
+
+START_TEST(test_query_cache)
+{
+    g_autoptr(DnfSack) sack = dnf_sack_new();
+    dnf_sack_set_cachedir(sack, test_globals.tmpdir);
+    g_autofree gchar *path = g_build_filename (TESTDATADIR, "/hawkey/yum/tour-4-6.noarch.rpm", NULL);
+    g_autoptr(DnfPackage) pkg = dnf_sack_add_cmdline_package (sack, path);
+
+    fail_if(dnf_sack_get_query_cache_enabled(sack));
+    dnf_sack_set_query_cache_enabled(sack, TRUE);
+    fail_unless(dnf_sack_get_query_cache_enabled(sack));
+
+    libdnf::Query first(sack);
+    first.addFilter(HY_PKG_NAME, HY_EQ, "tour");
+    fail_unless(first.size() == 1);
+
+    // the same query is answered from the cache without running any filter
+    libdnf::Query second(sack);
+    second.setProfiling(true);
+    second.addFilter(HY_PKG_NAME, HY_EQ, "tour");
+    fail_unless(second.size() == 1);
+    fail_unless(second.getProfile().empty());
+
+    // changing excludes starts a new generation
+    guint64 generation = dnf_sack_get_generation(sack);
+    libdnf::PackageSet excludes(sack);
+    excludes.set(dnf_package_get_id(pkg));
+    dnf_sack_add_excludes(sack, &excludes);
+    libdnf::Query third(sack);
+    third.setProfiling(true);
+    third.addFilter(HY_PKG_NAME, HY_EQ, "tour");
+    fail_unless(third.size() == 0);
+    fail_unless(third.getProfile().size() == 1);
+    fail_unless(dnf_sack_get_generation(sack) != generation);
+
+    dnf_sack_set_query_cache_enabled(sack, FALSE);
+}
+END_TEST
+
 START_TEST(test_repo_load)
 {
     fail_unless(dnf_sack_count(test_globals.sack) ==
@@ -267,6 +336,68 @@ START_TEST(test_presto_from_cache)
 }
 END_TEST
 
+START_TEST(test_evr_order)
+{
+    DnfSack *sack = test_globals.sack;
+    Pool *pool = dnf_sack_get_pool(sack);
+    const gboolean byArchModes[] = {FALSE, TRUE};
+    int npackages = 0;
+    Id p;
+
+    FOR_PKG_SOLVABLES(p)
+        npackages++;
+
+    for (auto byArch : byArchModes) {
+        int count;
+        const Id *order = dnf_sack_get_evr_order(sack, byArch, &count);
+        ck_assert_int_eq(count, npackages);
+
+        // sorting the packages on their own gives the same order
+        std::vector<Id> sorted(order, order + count);
+        std::reverse(sorted.begin(), sorted.end());
+        dnf_sack_sort_evr_order(sack, sorted.data(), count, byArch);
+        fail_unless(std::equal(sorted.begin(), sorted.end(), order));
+
+        for (int i = 1; i < count; ++i) {
+            Solvable *previous = pool_id2solvable(pool, order[i - 1]);
+            Solvable *s = pool_id2solvable(pool, order[i]);
+            fail_unless(previous->name <= s->name);
+            if (previous->name != s->name)
+                continue;
+            if (byArch) {
+                fail_unless(previous->arch <= s->arch);
+                if (previous->arch != s->arch)
+                    continue;
+            }
+            fail_unless(pool_evrcmp(pool, previous->evr, s->evr, EVRCMP_COMPARE) >= 0);
+        }
+    }
+}
+END_TEST
+
+START_TEST(test_evr_ranks)
+{
+    DnfSack *sack = test_globals.sack;
+    Pool *pool = dnf_sack_get_pool(sack);
+    const int *ranks = dnf_sack_get_evr_ranks(sack);
+    Id p, q;
+
+    // ranks of packages with the same name agree with pool_evrcmp()
+    FOR_PKG_SOLVABLES(p) {
+        Solvable *sp = pool_id2solvable(pool, p);
+        FOR_PKG_SOLVABLES(q) {
+            Solvable *sq = pool_id2solvable(pool, q);
+            if (sp->name != sq->name)
+                continue;
+            int cmp = pool_evrcmp(pool, sp->evr, sq->evr, EVRCMP_COMPARE);
+            int rankCmp = ranks[p] - ranks[q];
+            fail_unless((cmp > 0) == (rankCmp > 0));
+            fail_unless((cmp < 0) == (rankCmp < 0));
+        }
+    }
+}
+END_TEST
+
 Suite *
 sack_suite(void)
 {
@@ -279,6 +410,8 @@ sack_suite(void)
     tcase_add_test(tc, test_load_repo_err);
     tcase_add_test(tc, test_repo_written);
     tcase_add_test(tc, test_add_cmdline_package);
+    tcase_add_test(tc, test_name_index);
+    tcase_add_test(tc, test_query_cache);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Repos");
@@ -296,6 +429,8 @@ sack_suite(void)
 
     tc = tcase_create("SackKnows");
     tcase_add_unchecked_fixture(tc, fixture_all, teardown);
+    tcase_add_test(tc, test_evr_order);
+    tcase_add_test(tc, test_evr_ranks);
     suite_add_tcase(s, tc);
 
     return s;
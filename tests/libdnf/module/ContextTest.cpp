@@ -8,6 +8,8 @@ CPPUNIT_TEST_SUITE_REGISTRATION(ContextTest);
 #include "libdnf/nevra.hpp"
 #include "libdnf/utils/File.hpp"
 #include "libdnf/sack/packageset.hpp"
+#include "libdnf/module/modulemd/ModuleDefaultsContainer.hpp"
+#include "libdnf/module/modulemd/ModuleMetadataCache.hpp"
 
 #include <memory>
 
@@ -76,6 +78,38 @@ void ContextTest::testLoadModules()
             sackHasNot(sack, module);
     }
 
+    {
+        // module metadata cache gives back the same modules and defaults as the yaml
+        g_autoptr(GPtrArray) parsed = ModuleMetadata::objectsFromString(yamlContent);
+        FILE *fp = tmpfile();
+        CPPUNIT_ASSERT(ModuleMetadataCache::write(parsed, fp));
+        rewind(fp);
+        g_autoptr(GPtrArray) cached = ModuleMetadataCache::read(fp);
+        fclose(fp);
+        CPPUNIT_ASSERT(cached != nullptr);
+
+        auto parsedModules = ModuleMetadata::wrapModulemdModule(parsed);
+        auto cachedModules = ModuleMetadata::wrapModulemdModule(cached);
+        CPPUNIT_ASSERT_EQUAL(parsedModules.size(), cachedModules.size());
+        for (size_t i = 0; i < parsedModules.size(); i++) {
+            CPPUNIT_ASSERT_EQUAL(parsedModules[i]->getName(), cachedModules[i]->getName());
+            CPPUNIT_ASSERT_EQUAL(parsedModules[i]->getStream(), cachedModules[i]->getStream());
+            CPPUNIT_ASSERT_EQUAL(parsedModules[i]->getVersion(), cachedModules[i]->getVersion());
+            CPPUNIT_ASSERT_EQUAL(parsedModules[i]->getContext(), cachedModules[i]->getContext());
+            CPPUNIT_ASSERT(parsedModules[i]->getArtifacts() == cachedModules[i]->getArtifacts());
+            CPPUNIT_ASSERT_EQUAL(parsedModules[i]->getDependencies().size(),
+                                 cachedModules[i]->getDependencies().size());
+        }
+
+        ModuleDefaultsContainer parsedDefaults;
+        parsedDefaults.fromObjects(parsed, 0);
+        parsedDefaults.resolve();
+        ModuleDefaultsContainer cachedDefaults;
+        cachedDefaults.fromObjects(cached, 0);
+        cachedDefaults.resolve();
+        CPPUNIT_ASSERT(parsedDefaults.getDefaultStreams() == cachedDefaults.getDefaultStreams());
+    }
+
     {
         libdnf::Query query{sack};
         // no match with modular RPM $name -> keep
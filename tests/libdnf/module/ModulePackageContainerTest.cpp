@@ -0,0 +1,174 @@
+#include "ModulePackageContainerTest.hpp"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ModulePackageContainerTest);
+
+#include <sstream>
+
+extern "C" {
+#include <solv/pool.h>
+#include <solv/repo.h>
+}
+
+#include "libdnf/goal/IdQueue.hpp"
+
+
+void ModulePackageContainerTest::setUp()
+{
+    container = std::unique_ptr<ModulePackageContainer>(
+        new ModulePackageContainer(std::shared_ptr<Pool>(pool_create(), &pool_free), "x86_64"));
+    repo = repo_create(container->getPool().get(), "test");
+}
+
+void ModulePackageContainerTest::tearDown()
+{
+    container.reset();
+}
+
+std::shared_ptr<ModulePackage> ModulePackageContainerTest::addModule(const std::string &name,
+                                                                     const std::string &stream,
+                                                                     long long version)
+{
+    std::ostringstream yaml;
+    yaml << "---\n"
+         << "document: modulemd\n"
+         << "version: 2\n"
+         << "data:\n"
+         << "  name: " << name << "\n"
+         << "  stream: " << stream << "\n"
+         << "  version: " << version << "\n"
+         << "  context: 00000000\n"
+         << "  arch: x86_64\n"
+         << "  summary: Fake module\n"
+         << "  description: Fake module\n"
+         << "  license:\n"
+         << "    module:\n"
+         << "    - MIT\n"
+         << "  artifacts:\n"
+         << "    rpms:\n"
+         << "    - " << name << "-0:" << stream << "-" << version << ".x86_64\n"
+         << "...\n";
+
+    auto metadata = ModuleMetadata::metadataFromString(yaml.str());
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), metadata.size());
+    auto modulePackage = std::make_shared<ModulePackage>(container->getPool().get(), repo, metadata[0]);
+    container->add(modulePackage);
+    return modulePackage;
+}
+
+std::set<std::string> ModulePackageContainerTest::getConflicts(
+    const std::shared_ptr<ModulePackage> &modulePackage) const
+{
+    Pool *pool = container->getPool().get();
+    libdnf::IdQueue conflicts;
+    solvable_lookup_deparray(pool_id2solvable(pool, modulePackage->getId()), SOLVABLE_CONFLICTS,
+                             conflicts.getQueue(), 0);
+
+    std::set<std::string> result;
+    for (int i = 0; i < conflicts.size(); ++i) {
+        result.insert(pool_dep2str(pool, conflicts[i]));
+    }
+    return result;
+}
+
+std::set<Id> ModulePackageContainerTest::getIds(
+    const std::vector<std::shared_ptr<ModulePackage>> &modulePackages)
+{
+    std::set<Id> result;
+    for (const auto &modulePackage : modulePackages) {
+        result.insert(modulePackage->getId());
+    }
+    return result;
+}
+
+void ModulePackageContainerTest::testEnable()
+{
+    auto first = addModule("httpd", "2.2", 1);
+    auto second = addModule("httpd", "2.4", 1);
+    auto third = addModule("httpd", "2.4", 2);
+    auto other = addModule("nodejs", "2.4", 1);
+
+    container->enable("httpd", "2.4");
+    container->enable("httpd", "missing");
+    container->enable("missing", "2.4");
+
+    CPPUNIT_ASSERT(!first->isEnabled());
+    CPPUNIT_ASSERT(second->isEnabled());
+    CPPUNIT_ASSERT(third->isEnabled());
+    CPPUNIT_ASSERT(!other->isEnabled());
+}
+
+void ModulePackageContainerTest::testCreateConflictsBetweenStreams()
+{
+    auto first = addModule("httpd", "2.2", 1);
+    auto second = addModule("httpd", "2.4", 1);
+    auto third = addModule("httpd", "2.4", 2);
+    auto fourth = addModule("httpd", "2.6", 1);
+    auto other = addModule("nodejs", "8", 1);
+
+    container->createConflictsBetweenStreams();
+
+    CPPUNIT_ASSERT(getConflicts(first) == std::set<std::string>({"module(httpd:2.4)", "module(httpd:2.6)"}));
+    CPPUNIT_ASSERT(getConflicts(second) == std::set<std::string>({"module(httpd:2.2)", "module(httpd:2.6)"}));
+    CPPUNIT_ASSERT(getConflicts(third) == std::set<std::string>({"module(httpd:2.2)", "module(httpd:2.6)"}));
+    CPPUNIT_ASSERT(getConflicts(fourth) == std::set<std::string>({"module(httpd:2.2)", "module(httpd:2.4)"}));
+    CPPUNIT_ASSERT(getConflicts(other).empty());
+}
+
+void ModulePackageContainerTest::testActivityChanges()
+{
+    auto httpd22 = addModule("httpd", "2.2", 1);
+    auto httpd24 = addModule("httpd", "2.4", 1);
+    auto nodejs = addModule("nodejs", "8", 1);
+    container->createConflictsBetweenStreams();
+    const std::map<std::string, std::string> defaultStreams{{"httpd", "2.2"}};
+
+    // the default stream is active
+    auto active = container->getActiveModulePackages(defaultStreams);
+    CPPUNIT_ASSERT(getIds(active) == std::set<Id>({httpd22->getId()}));
+    CPPUNIT_ASSERT(getIds(container->getLastActivityChange().activated) == std::set<Id>({httpd22->getId()}));
+    CPPUNIT_ASSERT(container->getLastActivityChange().deactivated.empty());
+
+    container->enable("nodejs", "8");
+    active = container->getActiveModulePackages(defaultStreams);
+    CPPUNIT_ASSERT(getIds(active) == std::set<Id>({httpd22->getId(), nodejs->getId()}));
+    CPPUNIT_ASSERT(getIds(container->getLastActivityChange().activated) == std::set<Id>({nodejs->getId()}));
+    CPPUNIT_ASSERT(container->getLastActivityChange().deactivated.empty());
+
+    // switch the stream, the enabled one replaces the default one
+    container->disable("httpd", "2.2");
+    container->enable("httpd", "2.4");
+    active = container->getActiveModulePackages(defaultStreams);
+    CPPUNIT_ASSERT(getIds(active) == std::set<Id>({httpd24->getId(), nodejs->getId()}));
+    CPPUNIT_ASSERT(getIds(container->getLastActivityChange().activated) == std::set<Id>({httpd24->getId()}));
+    CPPUNIT_ASSERT(getIds(container->getLastActivityChange().deactivated) == std::set<Id>({httpd22->getId()}));
+
+    // nothing changed
+    active = container->getActiveModulePackages(defaultStreams);
+    CPPUNIT_ASSERT(getIds(active) == std::set<Id>({httpd24->getId(), nodejs->getId()}));
+    CPPUNIT_ASSERT(container->getLastActivityChange().activated.empty());
+    CPPUNIT_ASSERT(container->getLastActivityChange().deactivated.empty());
+
+    // a disabled default stream is not active
+    container->disable("httpd", "2.4");
+    active = container->getActiveModulePackages(defaultStreams);
+    CPPUNIT_ASSERT(getIds(active) == std::set<Id>({nodejs->getId()}));
+    CPPUNIT_ASSERT(getIds(container->getLastActivityChange().deactivated) == std::set<Id>({httpd24->getId()}));
+}
+
+void ModulePackageContainerTest::testResolveAfterDependencyChange()
+{
+    addModule("httpd", "2.2", 1);
+    addModule("httpd", "2.4", 1);
+    container->enable("httpd", "2.2");
+    container->enable("httpd", "2.4");
+
+    // without conflicts both streams can be active
+    auto active = container->getActiveModulePackages(std::map<std::string, std::string>());
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), active.size());
+
+    // the same request is solved again once the streams conflict
+    container->createConflictsBetweenStreams();
+    active = container->getActiveModulePackages(std::map<std::string, std::string>());
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), active.size());
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), container->getLastActivityChange().deactivated.size());
+}
@@ -0,0 +1,41 @@
+#ifndef LIBDNF_MODULEPACKAGECONTAINERTEST_HPP
+#define LIBDNF_MODULEPACKAGECONTAINERTEST_HPP
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <memory>
+#include <set>
+#include <string>
+
+#include "libdnf/module/ModulePackageContainer.hpp"
+
+class ModulePackageContainerTest : public CppUnit::TestCase
+{
+    CPPUNIT_TEST_SUITE(ModulePackageContainerTest);
+        CPPUNIT_TEST(testEnable);
+        CPPUNIT_TEST(testCreateConflictsBetweenStreams);
+        CPPUNIT_TEST(testActivityChanges);
+        CPPUNIT_TEST(testResolveAfterDependencyChange);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void testEnable();
+    void testCreateConflictsBetweenStreams();
+    void testActivityChanges();
+    void testResolveAfterDependencyChange();
+
+private:
+    std::shared_ptr<ModulePackage> addModule(const std::string &name, const std::string &stream,
+                                             long long version);
+    std::set<std::string> getConflicts(const std::shared_ptr<ModulePackage> &modulePackage) const;
+    static std::set<Id> getIds(const std::vector<std::shared_ptr<ModulePackage>> &modulePackages);
+
+    std::unique_ptr<ModulePackageContainer> container;
+    Repo *repo;
+};
+
+#endif //LIBDNF_MODULEPACKAGECONTAINERTEST_HPP
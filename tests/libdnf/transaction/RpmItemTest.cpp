@@ -86,3 +86,84 @@ RpmItemTest::testGetTransactionItems()
     //CPPUNIT_ASSERT(createMs.count() == 0);
     //CPPUNIT_ASSERT(readMs.count() == 0);
 }
+
+void
+RpmItemTest::testStatementCache()
+{
+    constexpr int num = 10;
+
+    auto hitsBefore = conn->getStatementCacheHits();
+    auto missesBefore = conn->getStatementCacheMisses();
+    for (int i = 0; i < num; i++) {
+        RPMItem rpm(conn);
+        rpm.setName("cached_" + std::to_string(i));
+        rpm.setEpoch(0);
+        rpm.setVersion("1");
+        rpm.setRelease("2");
+        rpm.setArch("x86_64");
+        rpm.save();
+
+        RPMItem rpm2(conn, rpm.getId());
+        CPPUNIT_ASSERT(rpm2.getName() == rpm.getName());
+    }
+
+    // the same statements are prepared once and then reused
+    auto misses = conn->getStatementCacheMisses() - missesBefore;
+    auto hits = conn->getStatementCacheHits() - hitsBefore;
+    CPPUNIT_ASSERT(misses > 0);
+    CPPUNIT_ASSERT(hits >= (num - 1) * misses);
+
+    // a disabled cache prepares every statement
+    conn->setStatementCacheSize(0);
+    hitsBefore = conn->getStatementCacheHits();
+    RPMItem rpm(conn);
+    rpm.setName("uncached");
+    rpm.setEpoch(0);
+    rpm.setVersion("1");
+    rpm.setRelease("2");
+    rpm.setArch("x86_64");
+    rpm.save();
+    CPPUNIT_ASSERT_EQUAL(hitsBefore, conn->getStatementCacheHits());
+}
+
+void
+RpmItemTest::testSaveNew()
+{
+    // more than one multi-row INSERT with a few rows left over
+    constexpr int num = 200;
+
+    auto createRPM = [this](const std::string &name, int32_t epoch) {
+        auto rpm = std::make_shared< RPMItem >(conn);
+        rpm->setName(name);
+        rpm->setEpoch(epoch);
+        rpm->setVersion("1");
+        rpm->setRelease("2");
+        rpm->setArch("x86_64");
+        return rpm;
+    };
+
+    auto saved = createRPM("new_0", 0);
+    saved->save();
+
+    std::vector< RPMItemPtr > rpms;
+    for (int i = 0; i < num; i++) {
+        rpms.push_back(createRPM("new_" + std::to_string(i), 0));
+    }
+    // the same NEVRA twice and a NEVRA that differs in epoch only
+    rpms.push_back(createRPM("new_1", 0));
+    rpms.push_back(createRPM("new_1", 1));
+    RPMItem::saveNew(conn, rpms);
+
+    // an RPM recorded already keeps its row
+    CPPUNIT_ASSERT_EQUAL(saved->getId(), rpms[0]->getId());
+    CPPUNIT_ASSERT_EQUAL(rpms[1]->getId(), rpms[num]->getId());
+    CPPUNIT_ASSERT(rpms[1]->getId() != rpms[num + 1]->getId());
+    for (auto &rpm : rpms) {
+        RPMItem loaded(conn, rpm->getId());
+        CPPUNIT_ASSERT_EQUAL(rpm->getNEVRA(), loaded.getNEVRA());
+    }
+
+    SQLite3::Query query(*conn, "SELECT count(*) FROM rpm");
+    query.step();
+    CPPUNIT_ASSERT_EQUAL(num + 1, query.get< int >(0));
+}
@@ -9,6 +9,8 @@ class RpmItemTest : public CppUnit::TestCase {
     CPPUNIT_TEST_SUITE(RpmItemTest);
     CPPUNIT_TEST(testCreate);
     CPPUNIT_TEST(testGetTransactionItems);
+    CPPUNIT_TEST(testStatementCache);
+    CPPUNIT_TEST(testSaveNew);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -17,6 +19,8 @@ public:
 
     void testCreate();
     void testGetTransactionItems();
+    void testStatementCache();
+    void testSaveNew();
 
 private:
     std::shared_ptr< SQLite3 > conn;
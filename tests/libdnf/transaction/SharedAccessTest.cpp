@@ -0,0 +1,153 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "libdnf/transaction/RPMItem.hpp"
+#include "libdnf/transaction/Swdb.hpp"
+#include "libdnf/transaction/Transaction.hpp"
+#include "libdnf/transaction/TransactionItem.hpp"
+#include "libdnf/transaction/Transformer.hpp"
+#include "libdnf/utils/sqlite3/Sqlite3.hpp"
+
+#include "SharedAccessTest.hpp"
+
+using namespace libdnf;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SharedAccessTest);
+
+void
+SharedAccessTest::setUp()
+{
+    char tmpl[] = "/tmp/libdnf-swdb-XXXXXX";
+    CPPUNIT_ASSERT(mkdtemp(tmpl) != nullptr);
+    tmpDir = tmpl;
+    dbPath = tmpDir + "/history.sqlite";
+}
+
+void
+SharedAccessTest::tearDown()
+{
+    for (auto suffix : {"", "-wal", "-shm", "-journal"}) {
+        unlink((dbPath + suffix).c_str());
+    }
+    rmdir(tmpDir.c_str());
+}
+
+void
+SharedAccessTest::testReadersWithWriter()
+{
+    const std::size_t transactionCount = 30;
+    const std::size_t itemCount = 20;
+    const int readerCount = 4;
+
+    auto conn = std::make_shared< SQLite3 >(dbPath, SQLite3::Mode::SHARED);
+    Transformer::createDatabase(conn);
+
+    std::atomic< bool > writerDone{false};
+    std::atomic< std::size_t > maxSeen{0};
+    std::mutex errorsMutex;
+    std::vector< std::string > errors;
+
+    auto reader = [&]() {
+        try {
+            Swdb swdb(dbPath, SQLite3::Mode::READ_ONLY);
+            std::size_t seen = 0;
+            bool finished;
+            do {
+                // checked before the query, so the last round sees everything the writer wrote
+                finished = writerDone;
+                auto transactions = swdb.listTransactions();
+                if (transactions.size() < seen) {
+                    throw std::runtime_error("transactions disappeared");
+                }
+                seen = transactions.size();
+                for (auto &trans : transactions) {
+                    // a transaction is visible only together with all its items
+                    if (trans->getItems().size() != itemCount) {
+                        throw std::runtime_error("partially written transaction");
+                    }
+                }
+                auto max = maxSeen.load();
+                while (max < seen && !maxSeen.compare_exchange_weak(max, seen)) {
+                }
+            } while (!finished);
+            if (seen != transactionCount) {
+                throw std::runtime_error("reader didn't see all transactions");
+            }
+        } catch (const std::exception &ex) {
+            std::lock_guard< std::mutex > guard(errorsMutex);
+            errors.push_back(ex.what());
+        }
+    };
+
+    std::vector< std::thread > readers;
+    for (int i = 0; i < readerCount; ++i) {
+        readers.emplace_back(reader);
+    }
+
+    {
+        Swdb swdb(conn);
+        for (std::size_t i = 0; i < transactionCount; ++i) {
+            swdb.initTransaction();
+            for (std::size_t j = 0; j < itemCount; ++j) {
+                auto rpm = swdb.createRPMItem();
+                rpm->setName("pkg-" + std::to_string(i) + "-" + std::to_string(j));
+                rpm->setEpoch(0);
+                rpm->setVersion("1.0");
+                rpm->setRelease("1");
+                rpm->setArch("x86_64");
+                swdb.addItem(rpm, "base", TransactionItemAction::INSTALL, TransactionItemReason::USER);
+            }
+            swdb.beginTransaction(i + 1, "", "", 0);
+            for (auto &transItem : swdb.getItems()) {
+                transItem->setState(TransactionItemState::DONE);
+            }
+            swdb.endTransaction(i + 2, "", TransactionState::DONE);
+
+            // readers have to get through while the writer keeps the database open
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (maxSeen <= i && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if (maxSeen <= i) {
+                std::lock_guard< std::mutex > guard(errorsMutex);
+                errors.push_back("readers are blocked by the writer");
+                break;
+            }
+        }
+    }
+    writerDone = true;
+
+    for (auto &thread : readers) {
+        thread.join();
+    }
+    for (auto &error : errors) {
+        CPPUNIT_FAIL(error);
+    }
+}
+
+void
+SharedAccessTest::testReadOnly()
+{
+    // read-only opening neither creates nor migrates the database
+    CPPUNIT_ASSERT_THROW(Swdb(dbPath, SQLite3::Mode::READ_ONLY), SQLite3::LibException);
+    CPPUNIT_ASSERT(access(dbPath.c_str(), F_OK) != 0);
+
+    {
+        auto conn = std::make_shared< SQLite3 >(dbPath);
+        Transformer::createDatabase(conn);
+    }
+
+    Swdb swdb(dbPath, SQLite3::Mode::READ_ONLY);
+    CPPUNIT_ASSERT(swdb.listTransactions().empty());
+    CPPUNIT_ASSERT_THROW(swdb.initTransaction(), std::logic_error);
+    CPPUNIT_ASSERT_THROW(swdb.getConn()->exec("DELETE FROM trans"), SQLite3::LibException);
+}
@@ -0,0 +1,27 @@
+#ifndef LIBDNF_SWDB_SHARED_ACCESS_TEST_HPP
+#define LIBDNF_SWDB_SHARED_ACCESS_TEST_HPP
+
+#include <string>
+
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class SharedAccessTest : public CppUnit::TestCase {
+    CPPUNIT_TEST_SUITE(SharedAccessTest);
+    CPPUNIT_TEST(testReadersWithWriter);
+    CPPUNIT_TEST(testReadOnly);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void testReadersWithWriter();
+    void testReadOnly();
+
+private:
+    std::string tmpDir;
+    std::string dbPath;
+};
+
+#endif // LIBDNF_SWDB_SHARED_ACCESS_TEST_HPP
@@ -315,3 +315,65 @@ TransactionItemReasonTest::testRemovedPackage()
         TransactionItemReason::GROUP,
         static_cast< TransactionItemReason >(swdb.resolveRPMTransactionItemReason("bash", "", -1)));
 }
+
+// reasons of all packages resolved at once -> same results as resolving them one by one
+void
+TransactionItemReasonTest::testBulkResolve()
+{
+    Swdb swdb(conn);
+
+    {
+        swdb.initTransaction();
+
+        auto rpm_bash = std::make_shared< RPMItem >(conn);
+        rpm_bash->setName("bash");
+        rpm_bash->setEpoch(0);
+        rpm_bash->setVersion("4.4.12");
+        rpm_bash->setRelease("5.fc26");
+        rpm_bash->setArch("x86_64");
+        std::string repoid = "base";
+        TransactionItemAction action = TransactionItemAction::INSTALL;
+        TransactionItemReason reason = TransactionItemReason::DEPENDENCY;
+        auto ti = swdb.addItem(rpm_bash, repoid, action, reason);
+        ti->setState(TransactionItemState::DONE);
+
+        auto rpm_bash_i686 = std::make_shared< RPMItem >(conn);
+        rpm_bash_i686->setName("bash");
+        rpm_bash_i686->setEpoch(0);
+        rpm_bash_i686->setVersion("4.4.12");
+        rpm_bash_i686->setRelease("5.fc26");
+        rpm_bash_i686->setArch("i686");
+        reason = TransactionItemReason::USER;
+        auto ti_i686 = swdb.addItem(rpm_bash_i686, repoid, action, reason);
+        ti_i686->setState(TransactionItemState::DONE);
+
+        swdb.beginTransaction(1, "", "", 0);
+        swdb.endTransaction(2, "", TransactionState::DONE);
+
+        swdb.initTransaction();
+        action = TransactionItemAction::REASON_CHANGE;
+        reason = TransactionItemReason::USER;
+        auto ti_change = swdb.addItem(rpm_bash, repoid, action, reason);
+        ti_change->setState(TransactionItemState::DONE);
+        action = TransactionItemAction::REMOVE;
+        auto ti_remove = swdb.addItem(rpm_bash_i686, repoid, action, reason);
+        ti_remove->setState(TransactionItemState::DONE);
+        swdb.beginTransaction(3, "", "", 0);
+        swdb.endTransaction(4, "", TransactionState::DONE);
+    }
+
+    auto reasons = RPMItem::resolveTransactionItemReasons(conn);
+    CPPUNIT_ASSERT_EQUAL(static_cast< size_t >(2), reasons.size());
+
+    // the latest transaction wins
+    CPPUNIT_ASSERT_EQUAL(TransactionItemReason::USER,
+                         reasons.at(std::make_pair(std::string("bash"), std::string("x86_64"))));
+    CPPUNIT_ASSERT_EQUAL(swdb.resolveRPMTransactionItemReason("bash", "x86_64", -1),
+                         reasons.at(std::make_pair(std::string("bash"), std::string("x86_64"))));
+
+    // removed package -> UNKNOWN
+    CPPUNIT_ASSERT_EQUAL(TransactionItemReason::UNKNOWN,
+                         reasons.at(std::make_pair(std::string("bash"), std::string("i686"))));
+    CPPUNIT_ASSERT_EQUAL(swdb.resolveRPMTransactionItemReason("bash", "i686", -1),
+                         reasons.at(std::make_pair(std::string("bash"), std::string("i686"))));
+}
@@ -1,7 +1,12 @@
+#include <map>
+#include <string>
+#include <vector>
+
 #include "libdnf/transaction/RPMItem.hpp"
 #include "libdnf/transaction/Transaction.hpp"
 #include "libdnf/transaction/private/Transaction.hpp"
 #include "libdnf/transaction/Transformer.hpp"
+#include "libdnf/transaction/TransactionItem.hpp"
 
 #include "../backports.hpp"
 
@@ -120,3 +125,46 @@ TransactionTest::testComparison()
     second.setRpmdbVersionBegin("0");
     CPPUNIT_ASSERT(first == second);
 }
+
+void
+TransactionTest::testSaveManyItems()
+{
+    // more items than fit into a single multi-row INSERT
+    const int count = 500;
+
+    libdnf::swdb_private::Transaction trans(conn);
+    std::map< int64_t, std::string > names;
+    std::vector< TransactionItemPtr > transItems;
+    for (int i = 0; i < count; ++i) {
+        auto rpm = std::make_shared< RPMItem >(conn);
+        rpm->setName("pkg" + std::to_string(i));
+        rpm->setEpoch(0);
+        rpm->setVersion("1.0");
+        rpm->setRelease("1");
+        rpm->setArch("x86_64");
+        auto action = i % 2 ? TransactionItemAction::INSTALL : TransactionItemAction::REMOVE;
+        transItems.push_back(
+            trans.addItem(rpm, i % 3 ? "base" : "updates", action, TransactionItemReason::USER));
+    }
+    trans.begin();
+
+    // the connection must not be left in an open transaction
+    CPPUNIT_ASSERT(conn->isAutocommit());
+
+    for (auto &transItem : transItems) {
+        CPPUNIT_ASSERT(transItem->getId() > 0);
+        names[transItem->getId()] = transItem->getItem()->toStr();
+    }
+    CPPUNIT_ASSERT_EQUAL(static_cast< size_t >(count), names.size());
+
+    // ids assigned to the items match the rows stored in the database
+    libdnf::Transaction trans2(conn, trans.getId());
+    auto loaded = trans2.getItems();
+    CPPUNIT_ASSERT_EQUAL(static_cast< size_t >(count), loaded.size());
+    for (auto &transItem : loaded) {
+        CPPUNIT_ASSERT_EQUAL(names.at(transItem->getId()), transItem->getItem()->toStr());
+        auto index = std::stoi(transItem->getRPMItem()->getName().substr(3));
+        CPPUNIT_ASSERT_EQUAL(std::string(index % 3 ? "base" : "updates"), transItem->getRepoid());
+        CPPUNIT_ASSERT(transItems[index]->getAction() == transItem->getAction());
+    }
+}